@@ -0,0 +1,152 @@
+#include <VirtualMachine.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// Cost of dispatching one bytecode instruction. Runs a loop of cheap
+// integer instructions in a random order, so which handler comes next is
+// hard to predict, and the same arithmetic compiled as C++. Build with
+// -DINTERPRETER_SWITCH_DISPATCH=ON to compare against the switch.
+// Usage: Dispatch_bench [millions of iterations]
+
+static const uint32_t COUNTER = 0;
+static const uint32_t X = 1;
+static const uint32_t Y = 2;
+static const uint32_t ONE = 3;
+static const uint32_t LIMIT = 4;
+
+static const int BODY = 32;
+
+Instruction make(uint32_t op, uint32_t dst, uint32_t a, uint32_t b)
+{
+    Instruction i;
+    i.op = op;
+    i.dst = dst;
+    i.a = a;
+    i.b = b;
+
+    return i;
+}
+
+Program make_program(int iterations, std::vector<int>& body)
+{
+    Program p;
+
+    p.variables = 3;
+    p.names.push_back("i");
+    p.names.push_back("x");
+    p.names.push_back("y");
+
+    p.constants.push_back(1);
+    p.constants.push_back(iterations);
+    p.constant_types.push_back(Type::INTEGER);
+    p.constant_types.push_back(Type::INTEGER);
+
+    p.registers = p.variables + uint32_t(p.constants.size());
+
+    for (uint32_t v = 0; v < p.variables; v++)
+    {
+        p.code.push_back(make(Instruction::MOVE, v, ONE, 0));
+        p.code.push_back(make(Instruction::DECLARE, v, Type::INTEGER, 0));
+    }
+
+    uint32_t loop = uint32_t(p.code.size());
+
+    for (int j = 0; j < BODY; j++)
+    {
+        switch (body[j])
+        {
+        case 0:
+            p.code.push_back(make(Instruction::ADD_I, X, X, Y));
+            break;
+        case 1:
+            p.code.push_back(make(Instruction::SUB_I, Y, X, ONE));
+            break;
+        case 2:
+            p.code.push_back(make(Instruction::MUL_I, Y, Y, X));
+            break;
+        default:
+            p.code.push_back(make(Instruction::MOVE, Y, X, 0));
+            break;
+        }
+    }
+
+    p.code.push_back(make(Instruction::ADD_I, COUNTER, COUNTER, ONE));
+    p.code.push_back(make(Instruction::JLT_I, loop, COUNTER, LIMIT));
+    p.code.push_back(make(Instruction::HALT, 0, 0, 0));
+
+    return p;
+}
+
+// The same loop without an interpreter
+int run_native(int iterations, const std::vector<int>& body)
+{
+    volatile int start = 1;
+    int x = start, y = start;
+
+    for (int i = start; i < iterations; i++)
+    {
+        for (int j = 0; j < BODY; j++)
+        {
+            switch (body[j])
+            {
+            case 0:
+                x = int(unsigned(x) + unsigned(y));
+                break;
+            case 1:
+                y = int(unsigned(x) - 1u);
+                break;
+            case 2:
+                y = int(unsigned(y) * unsigned(x));
+                break;
+            default:
+                y = x;
+                break;
+            }
+        }
+    }
+
+    return x + y;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = (argc > 1 ? atoi(argv[1]) : 10) * 1000000 / BODY;
+
+    srand(1);
+
+    std::vector<int> body;
+
+    for (int j = 0; j < BODY; j++)
+    {
+        body.push_back(rand() % 4);
+    }
+
+    Program program = make_program(iterations, body);
+
+    // The loop runs iterations - 1 times, each one is the body, the
+    // increment and the jump
+    double instructions = double(iterations - 1) * (BODY + 2);
+
+    Frame frame;
+    VirtualMachine vm;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    vm.run(program, frame);
+    double vm_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    int native = run_native(iterations, body);
+    double native_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double vm_ns = vm_seconds * 1e9 / instructions;
+    double native_ns = native_seconds * 1e9 / instructions;
+
+    std::cout << VirtualMachine::dispatch() << " dispatch, " << instructions / 1e6 << " M instructions" << std::endl;
+    std::cout << "VM: " << vm_ns << " ns per instruction" << std::endl;
+    std::cout << "Native: " << native_ns << " ns per operation (" << native % 2 << ")" << std::endl;
+    std::cout << "Dispatch overhead: " << vm_ns - native_ns << " ns per instruction" << std::endl;
+
+    return 0;
+}
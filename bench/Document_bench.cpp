@@ -0,0 +1,51 @@
+#include <Document.h>
+
+#include <chrono>
+#include <iostream>
+
+// Time to get a parsed tree back after a one-character edit, against a
+// full parse of the same script. Usage: Document_bench [thousands of lines]
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t thousands = argc > 1 ? std::stoul(argv[1]) : 200;
+
+    std::string code = "int a = 0; float b = 1.5;\n";
+
+    for (size_t i = 0; i < thousands * 1000 / 2; i++)
+    {
+        code += "a = a + " + std::to_string(i % 1000) + " * (a - 3);\n";
+        code += "if (a < 10) { b = b * 2.5; } else { b = b / 3.; };\n";
+    }
+
+    Document d;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    d.reset(code);
+    double full_seconds = seconds_since(start);
+
+    static const int EDITS = 1000;
+
+    start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < EDITS; i++)
+    {
+        // Turns a '2' of some "2.5" into a digit and back, spread over the file
+        size_t offset = d.text().find("2.5", code.size() / EDITS * i);
+
+        d.edit(offset, 1, i % 2 ? "2" : "7");
+    }
+
+    double edit_seconds = seconds_since(start) / EDITS;
+
+    std::cout << code.size() / 1024 << " KiB" << std::endl;
+    std::cout << "full parse: " << full_seconds * 1e3 << " ms" << std::endl;
+    std::cout << "edit: " << edit_seconds * 1e6 << " us, " << d.reparsed_length() << " bytes parsed again" << std::endl;
+
+    return 0;
+}
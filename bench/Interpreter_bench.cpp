@@ -0,0 +1,148 @@
+#include <Interpreter.h>
+#include <Optimizer.h>
+
+#include <chrono>
+#include <iostream>
+
+// Runs the same loops over the Node tree, over its FlatAst, as bytecode, as
+// closures and over the tree after the Optimizer: arithmetic mixing floats
+// and integers, integers only, Fibonacci numbers like Service_test's,
+// arithmetic full of constants and feature flag branches of a generated
+// script. Usage: Interpreter_bench [thousands of iterations]
+
+std::string make_mixed_script(size_t iterations)
+{
+    std::string out = "int a = 1; float b = 0.5; int i = 0;\n";
+
+    out += "while (i < " + std::to_string(iterations) + ") {\n";
+
+    for (int j = 0; j < 8; j++)
+    {
+        out += "    a = (a * 3 + i - " + std::to_string(j) + ") / 4 - (a - 7) / 5;\n";
+        out += "    b = b * 0.5 + (b - 2.) / (a * a + 1) + 1.5;\n";
+    }
+
+    out += "    i = i + 1;\n};\nprint(a, b);\n";
+
+    return out;
+}
+
+std::string make_int_script(size_t iterations)
+{
+    std::string out = "int a = 1; int s = 0;\n";
+
+    out += "for (int i = 0; i < " + std::to_string(iterations) + "; i = i + 1) {\n";
+
+    for (int j = 0; j < 8; j++)
+    {
+        out += "    a = (a * 3 + i - " + std::to_string(j) + ") - (a - 7) * 3;\n";
+        out += "    s = s + a * 2 - i * 2 - 42;\n";
+    }
+
+    out += "};\nprint(a, s);\n";
+
+    return out;
+}
+
+std::string make_fibonacci_script(size_t iterations)
+{
+    std::string out = "int a = 0; int b = 1; int c;\n";
+
+    out += "for (int i = 0; i < " + std::to_string(iterations) + "; i = i + 1) {\n";
+    out += "    c = a + b; a = b; b = c;\n";
+    out += "    if (b > 1000000) { a = 0; b = 1; } else { c = 0; };\n";
+    out += "};\nprint(a, b);\n";
+
+    return out;
+}
+
+std::string make_constant_script(size_t iterations)
+{
+    std::string out = "int a = 0; float b = 1.5; int i = 0;\n";
+
+    out += "while (i < " + std::to_string(iterations) + ") {\n";
+
+    for (int j = 0; j < 8; j++)
+    {
+        out += "    a = a * 1 + (2 * 3 + 4) * " + std::to_string(j) + " - 40 + i * 0;\n";
+        out += "    b = (b + 2.5 * 4) / 8 + 1. / 2 - 0;\n";
+    }
+
+    out += "    i = i + 1;\n};\nprint(a, b);\n";
+
+    return out;
+}
+
+std::string make_flags_script(size_t iterations)
+{
+    std::string out = "int a = 0; float b = 0.5; int i = 0;\n";
+
+    out += "while (i < " + std::to_string(iterations) + ") {\n";
+
+    for (int j = 0; j < 8; j++)
+    {
+        std::string flag = std::to_string(j % 3);
+
+        out += "    if (" + flag + " > 1) { a = a + i; } else { a = a - 1; };\n";
+        out += "    if ((" + flag + " == 0) && (a > 0)) { b = b * 0.5; } else { };\n";
+        out += "    while (" + flag + " < 0) { b = b + 1.; };\n";
+    }
+
+    out += "    i = i + 1;\n};\nprint(a, b);\n";
+
+    return out;
+}
+
+template <class Tree>
+double run_seconds(const Tree& tree, Interpreter::Engine engine = Interpreter::TREE_WALKER)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    Interpreter i(engine);
+    i.run(tree);
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void run_script(const std::string& title, const std::string& script)
+{
+    Lexer l;
+    Parser p(l.make_tokens(script));
+
+    std::shared_ptr<SequenceNode> tree = p.make_tree();
+    FlatAst flat(tree.get());
+
+    double tree_seconds = run_seconds<const Node*>(tree.get());
+    double flat_seconds = run_seconds<FlatAst>(flat);
+    double bytecode_seconds = run_seconds<const Node*>(tree.get(), Interpreter::BYTECODE);
+    double closure_seconds = run_seconds<const Node*>(tree.get(), Interpreter::CLOSURES);
+
+    // The pass rewrites the tree, so it gets one of its own
+    Parser optimized_parser(l.make_tokens(script));
+    std::shared_ptr<SequenceNode> optimized = optimized_parser.make_tree();
+
+    Optimizer optimizer(*optimized_parser.get_arena());
+    optimizer.optimize(optimized.get());
+
+    double optimized_seconds = run_seconds<const Node*>(optimized.get());
+
+    std::cout << title << ": " << flat.size() << " nodes, " << p.get_arena()->size() / flat.size() << " bytes per node in the tree, " << sizeof(FlatNode) << " flat" << std::endl;
+    std::cout << "Node tree: " << tree_seconds << " s" << std::endl;
+    std::cout << "FlatAst: " << flat_seconds << " s" << std::endl;
+    std::cout << "Bytecode: " << bytecode_seconds << " s, " << tree_seconds / bytecode_seconds << "x the tree" << std::endl;
+    std::cout << "Closures: " << closure_seconds << " s, " << tree_seconds / closure_seconds << "x the tree" << std::endl;
+    std::cout << "Optimized tree: " << optimized_seconds << " s, " << tree_seconds / optimized_seconds << "x the tree, " << optimizer.changes() << " operations removed, " << FlatAst(optimized.get()).size() << " nodes left" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    size_t thousands = argc > 1 ? std::stoul(argv[1]) : 200;
+
+    run_script("Mixed", make_mixed_script(thousands * 1000));
+    run_script("Integers", make_int_script(thousands * 1000));
+    run_script("Fibonacci", make_fibonacci_script(thousands * 10000));
+    run_script("Constants", make_constant_script(thousands * 1000));
+    run_script("Flags", make_flags_script(thousands * 1000));
+
+    return 0;
+}
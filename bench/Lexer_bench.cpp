@@ -0,0 +1,68 @@
+#include <Lexer.h>
+#include <Scanner.h>
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+// Lexer throughput in MB/s for every scanner level the CPU supports, then
+// for the parallel lexer with a growing number of threads.
+// Usage: Lexer_bench [megabytes]
+
+std::string make_script(size_t size)
+{
+    std::string out;
+
+    out.reserve(size + 256);
+
+    for (int i = 0; out.size() < size; i++)
+    {
+        out += "int generated_variable_" + std::to_string(i) + " = " + std::to_string(i * 31) + " * 2.5 + 17;\n";
+        out += "    for (int i = 0; i < 100; i = i + 1) { generated_variable_" + std::to_string(i) + " = i * 3; };\n";
+    }
+
+    return out;
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 64;
+
+    std::string code = make_script(megabytes * 1024 * 1024);
+
+    const char* names[] = { "scalar", "sse2", "avx2" };
+
+    Lexer l;
+
+    for (int level = SCAN_SCALAR; level <= best_scan_level(); level++)
+    {
+        set_scan_level(ScanLevel(level));
+
+        l.make_tokens(code.data(), 1024 * 1024); // warm up
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        size_t count = l.make_tokens(code).size();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << names[level] << ": " << count << " tokens, " << (code.size() / (1024.0 * 1024.0)) / seconds << " MB/s" << std::endl;
+    }
+
+    unsigned cores = std::thread::hardware_concurrency();
+
+    for (unsigned threads = 1; threads <= cores; threads *= 2)
+    {
+        TokenBuffer tokens;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        l.make_tokens_parallel(code.data(), code.size(), tokens, threads);
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "parallel, " << threads << " threads: " << tokens.size() << " tokens, " << (code.size() / (1024.0 * 1024.0)) / seconds << " MB/s" << std::endl;
+    }
+
+    return 0;
+}
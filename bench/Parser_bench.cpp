@@ -0,0 +1,57 @@
+#include <Parser.h>
+
+#include <chrono>
+#include <iostream>
+
+// Parse throughput for the same input held as std::vector<Token> and as a
+// TokenBuffer. Usage: Parser_bench [millions of tokens]
+
+std::string make_script(size_t tokens)
+{
+    std::string out = "int a = 0; float b = 1.5;\n";
+
+    // 24 tokens per line
+    for (size_t i = 0; i < tokens / 24; i++)
+    {
+        out += "a = a + " + std::to_string(i % 1000) + " * (a - 3);\n";
+        out += "if (a < 10) { b = b * 2.5; } else { b = b / 3.; };\n";
+    }
+
+    return out;
+}
+
+template <class Input>
+double parse_seconds(const Input& tokens)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    {
+        Parser p(tokens);
+        std::shared_ptr<SequenceNode> sn = p.make_tree();
+    }
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t millions = argc > 1 ? std::stoul(argv[1]) : 10;
+
+    std::string code = make_script(millions * 1000 * 1000);
+
+    Lexer l;
+
+    TokenBuffer buffer;
+    l.make_tokens(code.data(), code.size(), buffer);
+
+    std::vector<Token> vector = l.make_tokens(code);
+
+    double vector_seconds = parse_seconds(vector);
+    double buffer_seconds = parse_seconds(buffer);
+
+    std::cout << buffer.size() << " tokens" << std::endl;
+    std::cout << "std::vector<Token>: " << buffer.size() / vector_seconds / 1e6 << " M tokens/s" << std::endl;
+    std::cout << "TokenBuffer: " << buffer.size() / buffer_seconds / 1e6 << " M tokens/s" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#ifndef AST_ARENA_H
+#define AST_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Owns every node of one parsed program. Nodes are placed one after another
+// in large blocks and all of them go away with the arena, so building a tree
+// costs a pointer bump per node and nodes only point at each other with
+// plain pointers.
+class AstArena
+{
+public:
+    AstArena();
+    ~AstArena();
+
+    template <class T, class... Args>
+    T* make(Args&&... args)
+    {
+        T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+        // Most nodes hold nothing but numbers and pointers, only the rest
+        // need their destructor run
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            destructors.push_back(Destructor(object, &destroy<T>));
+        }
+
+        return object;
+    }
+
+    // Bytes handed out so far
+    size_t size() const { return used; }
+private:
+    AstArena(const AstArena& other);
+    AstArena& operator=(const AstArena& other);
+
+    void* allocate(size_t size, size_t align)
+    {
+        size_t padding = (align - reinterpret_cast<size_t>(current) % align) % align;
+
+        if (size + padding > size_t(end - current))
+        {
+            return allocate_slow(size, align);
+        }
+
+        void* p = current + padding;
+
+        current += padding + size;
+        used += size;
+
+        return p;
+    }
+
+    void* allocate_slow(size_t size, size_t align);
+
+    template <class T>
+    static void destroy(void* object)
+    {
+        static_cast<T*>(object)->~T();
+    }
+
+    typedef std::pair<void*, void (*)(void*)> Destructor;
+
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+
+    char* current;
+    char* end;
+
+    size_t used;
+
+    std::vector<Destructor> destructors;
+};
+
+#endif /* AST_ARENA_H */
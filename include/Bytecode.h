@@ -0,0 +1,137 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <Nodes.h>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// One instruction of a Program. Operands name registers, except where an
+// opcode says otherwise:
+//
+//   MOVE                  dst = a
+//   I2F, F2I              dst = a converted
+//   ADD_I ... MUL_F       dst = a op b, _I on ints, _F on floats
+//   DIV_F                 dst = a / b, throws ZeroDivisionError when b is 0
+//   NONZERO_F             throws ZeroDivisionError when a is 0
+//   DECLARE               dst: variable, a: Type::Types it now holds
+//   CHECK                 dst: variable that has to be declared by now
+//   JUMP                  dst: instruction to go on with
+//   JLT_I ... JNEQ_F      dst: instruction to go on with when the comparison
+//                         of a and b holds, JN*_F when it doesn't
+//   PRINT_I, PRINT_F      a: value to print
+//   PRINT_SPACE           prints what print() does for a non number
+//   PRINT_LINE            ends the line started by the PRINT_*s before it
+//   FAIL                  a: message of the InterpreterException to throw
+struct Instruction
+{
+    enum Opcodes
+    {
+        MOVE,
+        I2F, F2I,
+
+        ADD_I, SUB_I, MUL_I,
+        ADD_F, SUB_F, MUL_F, DIV_F,
+        NONZERO_F,
+
+        DECLARE,
+        CHECK,
+
+        JUMP,
+        JLT_I, JLE_I, JEQ_I, JNE_I,
+        JLT_F, JLE_F, JEQ_F,
+        JNLT_F, JNLE_F, JNEQ_F,
+
+        PRINT_I, PRINT_F, PRINT_SPACE, PRINT_LINE,
+
+        FAIL,
+        HALT,
+
+        OPCODES_COUNT
+    };
+
+    uint32_t op;
+    uint32_t dst;
+    uint32_t a;
+    uint32_t b;
+};
+
+// Code for the register machine in VirtualMachine.h. Registers are laid out
+// as the variables, by slot, then the temporaries and then the constants,
+// which the machine loads once before it starts.
+class Program
+{
+public:
+    Program() : variables(0), registers(0) {}
+
+    std::vector<Instruction> code;
+
+    // Values of the constant registers, the first of them is register
+    // variables + temporaries
+    std::vector<int32_t> constants;
+    std::vector<uint8_t> constant_types;
+
+    // Names of the variable registers, for errors and Interpreter::get_var()
+    std::vector<std::string> names;
+
+    // Of FAIL instructions
+    std::vector<std::string> messages;
+
+    uint32_t variables;
+    uint32_t registers;
+};
+
+// Turns a resolved Node tree into a Program. Integer expressions get the
+// _I instructions and everything else the _F ones, converting where the
+// two meet, just as Interpreter::calc_int() and calc_expr() do.
+class BytecodeCompiler
+{
+public:
+    BytecodeCompiler();
+
+    Program compile(const Node* root);
+private:
+    void statement(const Node* node);
+
+    // Register holding node's value as type. Variables and constants are
+    // used where they are, everything else goes to a new temporary.
+    uint32_t expr(const Node* node, int type);
+    void expr_into(const Node* node, int type, uint32_t dst);
+
+    // Jumps of comparisons, added to jumps for patch(), are taken when
+    // node is false, or true. Otherwise execution goes on after them.
+    void branch_false(const Node* node, std::vector<size_t>& jumps);
+    void branch_true(const Node* node, std::vector<size_t>& jumps);
+    void compare(const BinaryNode* node, bool when, std::vector<size_t>& jumps);
+
+    // Whether working node out can throw
+    bool may_throw(const Node* node) const;
+
+    uint32_t variable(const Node* node);
+    uint32_t slot(int slot, const std::string& name);
+    uint32_t constant(int type, int32_t bits);
+    uint32_t temporary();
+
+    size_t emit(uint32_t op, uint32_t dst, uint32_t a = 0, uint32_t b = 0);
+
+    // Code that throws what the tree walker would at this point
+    void fail(const std::string& message);
+
+    void patch(const std::vector<size_t>& jumps, size_t target);
+    size_t here() const { return program.code.size(); }
+
+    Program program;
+
+    // Variables whose declaration has run on every path to this point,
+    // reading any other one needs a CHECK first
+    std::vector<bool> declared;
+
+    uint32_t temporaries;
+    uint32_t max_temporaries;
+
+    std::unordered_map<uint64_t, uint32_t> constant_ids;
+};
+
+#endif /* BYTECODE_H */
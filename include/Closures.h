@@ -0,0 +1,41 @@
+#ifndef CLOSURES_H
+#define CLOSURES_H
+
+#include <Interpreter.h>
+
+#include <functional>
+#include <string>
+
+// A compiled statement, run over the variables of one Interpreter
+typedef std::function<void(Frame&)> Closure;
+
+// Turns a resolved Node tree into nested callables, each with its children,
+// constants and variable slots bound when it is made. Running one is a call
+// per node: the switches on Node::type and Node::valtype of the tree walker
+// are all taken here, once. It prints, throws and leaves variables behind
+// exactly as Interpreter::run() does over the tree.
+class ClosureCompiler
+{
+public:
+    typedef std::function<int(Frame&)> IntExpr;
+    typedef std::function<float(Frame&)> FloatExpr;
+    typedef std::function<bool(Frame&)> Condition;
+
+    // Adds one expression of a print() to its line
+    typedef std::function<void(Frame&, std::string&)> PrintItem;
+
+    Closure compile(const Node* root);
+private:
+    Closure statement(const Node* node);
+    PrintItem print_item(const Node* node);
+
+    // As Interpreter::calc_int(), int_expr() and calc_expr()
+    IntExpr calc_int(const Node* node);
+    IntExpr int_expr(const Node* node);
+    FloatExpr float_expr(const Node* node);
+
+    // As Interpreter::calc_logic()
+    Condition condition(const Node* node);
+};
+
+#endif /* CLOSURES_H */
@@ -0,0 +1,111 @@
+#ifndef DOCUMENT_H
+#define DOCUMENT_H
+
+#include <Parser.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+// A script that is edited in place and kept parsed. After an edit only the
+// statements touching it, in the innermost block around it, are lexed and
+// parsed again. The rest of the tree, including the nodes of every other
+// statement, is left as it was.
+//
+// When the edited statements don't parse on their own, the statement that
+// holds their block is parsed again instead, and so on outwards. Adding,
+// removing or retyping a declaration changes what later statements mean, so
+// that always parses the whole text again.
+class Document
+{
+public:
+    Document();
+
+    // Replaces the whole text. Throws LexerException/ParserException when it
+    // doesn't parse, in which case tree() is null until an edit fixes it.
+    void reset(const std::string& text);
+
+    // Removes removed bytes at offset and puts inserted in their place.
+    // Throws like reset(), the text is changed either way.
+    void edit(size_t offset, size_t removed, const std::string& inserted);
+
+    const std::string& text() const { return source; }
+
+    std::shared_ptr<SequenceNode> tree() const { return root_node; }
+
+    // Positions for nodes of the current tree
+    LineIndex& line_index() { return lines; }
+
+    // Bytes lexed and parsed by the last reset() or edit()
+    size_t reparsed_length() const { return last_reparsed; }
+
+    struct Block;
+
+    // Offsets are kept relative to the enclosing block or statement, so an
+    // edit only has to move what follows it inside each enclosing block
+    struct Statement
+    {
+        // From the start of the enclosing block's contents
+        size_t begin;
+        size_t end;
+
+        Node* node;
+
+        // Bodies of if/else, for and while, in source order
+        std::vector<std::unique_ptr<Block>> blocks;
+    };
+
+    struct Block
+    {
+        // Between the braces, from the start of the statement owning the
+        // block. The outermost block covers the whole text.
+        size_t begin;
+        size_t end;
+
+        SequenceNode* node;
+
+        std::vector<Statement> statements;
+    };
+private:
+    Document(const Document& other);
+    Document& operator=(const Document& other);
+
+    struct Declaration
+    {
+        // Start of the innermost statement holding the declaration
+        size_t offset;
+        Type type;
+    };
+
+    enum ReparseResult
+    {
+        REPARSED,
+        TRY_OUTER, // the range doesn't parse on its own
+        TRY_ALL    // declarations changed
+    };
+
+    void parse_all();
+
+    // Parses statements [first, last) of block again, they cover the edit
+    // that replaced [edit_begin, edit_end) of the old text with inserted
+    // bytes. base is where the block's contents start in the text.
+    ReparseResult reparse(Block& block, size_t base, size_t first, size_t last, size_t edit_begin, size_t edit_end, size_t inserted);
+
+    void add_declarations(const Statement& statement, size_t base);
+
+    std::string source;
+    LineIndex lines;
+
+    std::shared_ptr<AstArena> arena;
+    std::shared_ptr<Resolver> resolver;
+    std::shared_ptr<SequenceNode> root_node;
+    std::unique_ptr<Block> root;
+
+    // Every declaration of every name, ordered by offset
+    std::unordered_map<std::string, std::vector<Declaration>> declarations;
+
+    size_t last_reparsed;
+};
+
+#endif /* DOCUMENT_H */
@@ -0,0 +1,95 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <Nodes.h>
+
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// One node of a FlatAst. What a, b and c hold depends on tag:
+//
+//   INTEGER, FLOAT        a: the value's bits
+//   VAR                   a: name, see FlatAst::name(), c: slot
+//   DECLVAR               a: name, b: expression or NONE, c: slot
+//   binary operators      a: left, b: right
+//   BRANCHING             a: condition, b: if body, c: else body or NONE
+//   WHILECYCLE            a: condition, b: body
+//   FORCYCLE              a: first of init, condition, step and body in the
+//                         child list, each of them may be NONE
+//   SEQUENCE, PRINT       a: first child in the child list, b: count
+struct FlatNode
+{
+    uint8_t tag;       // Node::Types
+    uint8_t vartype;   // Type::Types of VAR and DECLVAR, Node::valtype of the rest
+    uint8_t is_const;
+    uint8_t reserved;
+
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+};
+
+// A whole tree in one vector of fixed size records, children referring to
+// each other by index. Nodes are stored in pre-order, so walking an
+// expression reads memory front to back.
+class FlatAst
+{
+public:
+    static const uint32_t NONE = 0xFFFFFFFF;
+
+    FlatAst();
+    explicit FlatAst(const Node* root);
+
+    // Appends the tree and makes it the root. The parser's per-block
+    // variable types aren't kept.
+    uint32_t assign(const Node* root);
+
+    // Builds the tree back out of Node classes
+    Node* to_tree(AstArena& arena) const { return to_tree(arena, root_index); }
+    Node* to_tree(AstArena& arena, uint32_t index) const;
+
+    const FlatNode& at(uint32_t index) const { return nodes[index]; }
+
+    // Children of SEQUENCE, PRINT and FORCYCLE nodes
+    const uint32_t* children(const FlatNode& node) const { return &lists[node.a]; }
+
+    // Name of a VAR or DECLVAR node
+    const std::string& name(const FlatNode& node) const { return names[node.a]; }
+
+    uint32_t root() const { return root_index; }
+    bool empty() const { return nodes.empty(); }
+    size_t size() const { return nodes.size(); }
+
+    static int32_t int_value(const FlatNode& node)
+    {
+        int32_t value;
+        memcpy(&value, &node.a, sizeof(value));
+
+        return value;
+    }
+
+    static float float_value(const FlatNode& node)
+    {
+        float value;
+        memcpy(&value, &node.a, sizeof(value));
+
+        return value;
+    }
+private:
+    uint32_t add(const Node* node);
+    uint32_t add_list(const std::vector<Node*>& list);
+    uint32_t add_name(const std::string& name);
+
+    std::vector<FlatNode> nodes;
+    std::vector<uint32_t> lists;
+
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint32_t> name_ids;
+
+    uint32_t root_index;
+};
+
+#endif /* FLAT_AST_H */
@@ -2,6 +2,7 @@
 #define INTERPRETER_H
 
 #include<Parser.h>
+#include<FlatAst.h>
 #include<map>
 
 class InterpreterException
@@ -20,44 +21,93 @@ public:
     ZeroDivisionError() : InterpreterException("Zero division error") {}
 };
 
-class Variable
+// A variable's value in 8 bytes: the Type::Types it holds and the number.
+// Copying one is a single register move. A string, once the language has
+// them, would live out of line with the value holding its index.
+class Value
 {
 public:
-    Variable() {}
-    Variable(int ival) : ival(ival) {}
-    Variable(float fval) : fval(fval) {}
-    Variable(const std::string& sval) : sval(sval) {}
+    Value() : tag(Type::VOID), ival(0) {}
+    explicit Value(int ival) : tag(Type::INTEGER), ival(ival) {}
+    explicit Value(float fval) : tag(Type::FLOAT), fval(fval) {}
 
-    Variable(const Variable& other) { this->ival = other.ival; this->fval = other.fval; this->sval = other.sval; }
+    // Type::VOID until the variable is declared
+    uint32_t tag;
 
-    Variable operator=(const Variable& other)
+    union
     {
-        Variable out;
+        int ival;
+        float fval;
+    };
+};
 
-        out.ival = this->ival = other.ival;
-        out.fval = this->fval = other.fval;
-        out.sval = this->sval = other.sval;
+// Integer + - and * wrap around on overflow. They are worked out in
+// unsigned, where wrapping is defined, and turned back into an int.
+inline int int_add(int a, int b) { return int(unsigned(a) + unsigned(b)); }
+inline int int_subtract(int a, int b) { return int(unsigned(a) - unsigned(b)); }
+inline int int_multiply(int a, int b) { return int(unsigned(a) * unsigned(b)); }
+
+// Variables of one run, indexed by slot. The values sit unboxed in one
+// array, so reaching a variable is an index, and a slot is only set up the
+// first time its declaration runs. Running a declaration again, as loop
+// bodies do, just overwrites the value. A slot whose tag is still
+// Type::VOID hasn't been declared.
+class Frame
+{
+public:
+    void declare(int slot, const std::string& name, Value value);
+
+    // Throws when the declaration of the slot hasn't run yet
+    Value& at(int slot, const std::string& name)
+    {
+        if (size_t(slot) >= values.size() || values[slot].tag == Type::VOID)
+        {
+            undeclared(name);
+        }
 
-        return out;
+        return values[slot];
     }
 
-    int ival;
-    float fval;
-    std::string sval;
-};
+    // Null when no variable of that name was declared
+    const Value* find(const std::string& name) const;
 
-typedef std::unordered_map<std::string, std::shared_ptr<Variable>> NameField;
+    // What the slot holds, a Type::VOID value past the end
+    Value get(size_t slot) const { return slot < values.size() ? values[slot] : Value(); }
+    size_t size() const { return values.size(); }
+
+    // The slot's value if it holds type, null otherwise
+    Value* holding(int slot, uint32_t type)
+    {
+        return size_t(slot) < values.size() && values[slot].tag == type ? &values[slot] : 0;
+    }
+
+    // Throws the error at() gives for an undeclared variable
+    static void undeclared(const std::string& name);
+private:
+    std::vector<Value> values;
+    std::vector<std::string> names;
+};
 
 class Interpreter
 {
 public:
-    Interpreter();
+    enum Engine
+    {
+        TREE_WALKER, // runs the Node tree as it is
+        BYTECODE,    // compiles it for the VirtualMachine first
+        CLOSURES     // compiles it into callables, see ClosureCompiler
+    };
+
+    explicit Interpreter(Engine engine = TREE_WALKER);
     ~Interpreter();
 
+    // Variables have to be resolved, see Resolver. Trees from a Parser are.
+    // All engines print the same and leave the same variables behind.
     void run(const Node* node);
     void run_sequence(const SequenceNode* sn);
     void run_print(const PrintNode* pn);
     void run_assign(const AssignNode* an);
+    void run_increment(const AssignNode* an);
     void run_branching(const BranchingNode* bn);
     void run_for_cycle(const ForCycleNode* fcn);
     void run_while_cycle(const WhileCycleNode* wcn);
@@ -66,17 +116,40 @@ public:
     float calc_expr(const Node* node);
     bool calc_logic(const Node* node);
 
-    const NameField& get_current_name_field() const { return namefields.front(); }
-    NameField& get_current_name_field() { return namefields.front(); }
+    // Integer expressions are worked out in integers, any other expression
+    // is truncated
+    int calc_int(const Node* node);
 
-    const Variable& get_var(const std::string& name) const { return *get_current_name_field().at(name).get(); }
+    // The same over a flattened tree
+    void run(const FlatAst& ast) { run(ast, ast.root()); }
+    void run(const FlatAst& ast, uint32_t index);
+    float calc_expr(const FlatAst& ast, uint32_t index);
+    int calc_int(const FlatAst& ast, uint32_t index);
+    bool calc_logic(const FlatAst& ast, uint32_t index);
 
-    void init_var(const std::string& name) { get_current_name_field()[name] = std::shared_ptr<Variable>(new Variable()); }
-    void set_var_int_val(const std::string& name, int val) { get_current_name_field().at(name)->ival = val; };
-    void set_var_float_val(const std::string& name, float val) { get_current_name_field().at(name)->fval = val; };
-    void set_var_string_val(const std::string& name, const std::string& val) { get_current_name_field().at(name)->sval = val; };
+    // Looks the name up among the variables declared so far
+    const Value& get_var(const std::string& name) const;
 private:
-    std::vector<NameField> namefields;
+    void walk(const Node* node);
+
+    // calc_int() of an expression known to be Type::INTEGER
+    int int_expr(const Node* node);
+    int int_expr(const FlatAst& ast, uint32_t index);
+
+    // Rewrites node's runs_as into a specialized form when its shape allows,
+    // the first time the tree walker gets to it. The specialized forms
+    // check what they assume as they run and, where that fails, put runs_as
+    // back to type for good.
+    void quicken(const Node* node);
+
+    // The value of a constant, or of a variable holding an integer. False
+    // for a variable holding anything else.
+    bool int_leaf(const Node* node, int& value);
+
+    Value& var(int slot, const std::string& name) { return frame.at(slot, name); }
+
+    Engine engine;
+    Frame frame;
 };
 
 
@@ -4,6 +4,11 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <istream>
+#include <cstring>
+
+#include <SourceFile.h>
+#include <Symbols.h>
 
 #define DECL_TOKEN_TYPE(enum_val) const Token enum_val##_T(Token::enum_val)
 
@@ -11,21 +16,22 @@ class Token
 {
 public:
     int type;
-    int ival;
-    float fval;
-    std::string sval;
 
-    int line;
-    int chr;
+    union
+    {
+        int ival;
+        float fval;
+        int sym; // SymbolTable id of a STRING token
+    };
 
-    Token() : type(EMPTY) {}
-    Token(int type, int line = 0, int chr = 0, int val = 0) : type(type), ival(val), line(line), chr(chr) {}
-    Token(float val, int line = 0, int chr = 0) : type(FLOAT), fval(val), line(line), chr(chr) {}
-    Token(const std::string& val, int line = 0, int chr = 0) : type(STRING), sval(val), line(line), chr(chr) {}
+    size_t offset; // of the first character in the source
 
-    Token(const Token& other);
+    Token() : type(EMPTY), ival(0), offset(0) {}
+    Token(int type, size_t offset = 0, int val = 0) : type(type), ival(val), offset(offset) {}
+    Token(float val, size_t offset = 0) : type(FLOAT), fval(val), offset(offset) {}
+    Token(const std::string& val, size_t offset = 0) : type(STRING), sym(SymbolTable::global().intern(val)), offset(offset) {}
 
-    Token operator=(const Token& other);
+    const std::string& name() const { return SymbolTable::global().name(sym); }
 
     bool is_same(const Token& other) const;
     std::string to_string() const;
@@ -61,7 +67,9 @@ public:
         LESSER, GREATER, 
         LOQ, // Lesser or equal
         GOQ, // Greater or equal
-        OR, AND, OROR, ANDAND
+        OR, AND, OROR, ANDAND,
+
+        TYPES_COUNT
     };
 };
 
@@ -99,36 +107,216 @@ DECL_TOKEN_TYPE(ANDAND);
 class IntegerToken : public Token 
 {
 public:
-    IntegerToken(int val, int line = 0, int chr = 0) : Token(Token::INTEGER, line, chr, val) {};
+    IntegerToken(int val, size_t offset = 0) : Token(Token::INTEGER, offset, val) {};
 };
 
-class Lexer
+struct SourcePosition
 {
-private:
-    int position;
+    SourcePosition(size_t offset = 0, int line = 0, int column = 0) : offset(offset), line(line), column(column) {}
+
+    std::string to_string() const;
 
+    size_t offset;
+
+    // 1-based, 0 when the source text isn't available
     int line;
-    int chr;
+    int column;
+};
+
+class LexerException
+{
+public:
+    LexerException(std::string err = "") : err(err) {}
+
+    const std::string& what() const { return err; }
+protected:
+    std::string err;
+};
+
+class NumberOverflowError : public LexerException
+{
+public:
+    NumberOverflowError(const std::string& literal, SourcePosition pos) : LexerException("Number \'" + literal + "\' is out of range at " + pos.to_string()) {}
+};
+
+class InvalidNumberError : public LexerException
+{
+public:
+    InvalidNumberError(const std::string& literal, SourcePosition pos) : LexerException("Invalid number \'" + literal + "\' at " + pos.to_string()) {}
+};
+
+// Turns token offsets into line/column pairs. The table of line breaks is
+// only built the first time a diagnostic asks for a position.
+class LineIndex
+{
+public:
+    LineIndex() : code(""), length(0), built(false) {}
+    LineIndex(const char* code, size_t length) : code(code), length(length), built(false) {}
+
+    void reset(const char* code, size_t length);
+
+    // For sources that are read piece by piece and not kept in memory: line
+    // breaks are recorded as every piece arrives
+    void reset_stream();
+    void feed(const char* chunk, size_t chunk_length);
+
+    SourcePosition locate(size_t offset);
+private:
+    void build();
+
+    const char* code;
+    size_t length;
+
+    bool built;
+    std::vector<size_t> newlines;
+};
+
+// Tokens stored as separate arrays of types, offsets and values, so that
+// walking the token types touches one byte per token
+class TokenBuffer
+{
+public:
+    void push_back(const Token& t)
+    {
+        types.push_back((signed char)t.type);
+        offsets.push_back(t.offset);
+        values.push_back(t.ival);
+    }
 
-    std::unordered_map<std::string, int> keywords;
+    Token at(size_t i) const
+    {
+        Token t(int(types[i]), offsets[i]);
+        memcpy(&t.ival, &values[i], sizeof(int)); // ival, fval or sym
+        return t;
+    }
+
+    void set(size_t i, const Token& t)
+    {
+        types[i] = (signed char)t.type;
+        offsets[i] = t.offset;
+        values[i] = t.ival;
+    }
+
+    int type(size_t i) const { return types[i]; }
+    size_t offset(size_t i) const { return offsets[i]; }
+
+    size_t size() const { return types.size(); }
+    bool empty() const { return types.empty(); }
+
+    void reserve(size_t n);
+    void resize(size_t n);
+    void clear();
+private:
+    std::vector<signed char> types;
+    std::vector<size_t> offsets;
+    std::vector<int> values;
+};
+
+// Anything the Parser can pull tokens from
+class TokenSource
+{
+public:
+    virtual ~TokenSource() {}
+
+    // Returns false when there are no tokens left
+    virtual bool next_token(Token& out) = 0;
+};
+
+class VectorTokenSource : public TokenSource
+{
+public:
+    VectorTokenSource(std::vector<Token> tokens) : tokens(std::move(tokens)), position(0) {}
+
+    virtual bool next_token(Token& out);
+private:
+    std::vector<Token> tokens;
+    size_t position;
+};
+
+class Lexer : public TokenSource
+{
+private:
+    const char* code;
+    size_t length;
+    size_t position;
+
+    // Streaming input: code points into buffer, which holds the source
+    // from the offset base onwards
+    std::istream* input;
+    std::vector<char> buffer;
+    size_t base;
+
+    LineIndex lines;
+
+    // Where identifiers are interned, SymbolTable::global() by default
+    SymbolTable* symbols;
+
+    bool refill(size_t keep_from);
 public:
     Lexer();
     ~Lexer();
 
     std::vector<Token> make_tokens(const std::string& code);
+    std::vector<Token> make_tokens(const SourceFile& file);
+    std::vector<Token> make_tokens(const char* code, size_t length);
+
+    void make_tokens(const char* code, size_t length, TokenBuffer& out);
+
+    // Splits the input at whitespace, lexes the pieces on a pool of threads
+    // (one per core when threads is 0) and joins the results. Gives the same
+    // tokens as make_tokens().
+    void make_tokens_parallel(const char* code, size_t length, TokenBuffer& out, unsigned threads = 0);
 
-    Token make_number(const std::string& code);
+    // Incremental mode: after begin(), tokens are produced one by one by
+    // next_token(). The source has to stay alive until the last token.
+    void begin(const std::string& code) { begin(code.data(), code.length()); }
+    void begin(const SourceFile& file) { begin(file.data(), file.size()); }
+    void begin(const char* code, size_t length);
 
-    void advance(const std::string& code);
+    // Reads the input in chunks as tokens are requested, so lexing and
+    // parsing of piped input can start before all of it has arrived
+    void begin(std::istream& input);
+
+    virtual bool next_token(Token& out);
+
+    Token make_number();
+
+    // Valid as long as the last lexed source is alive
+    LineIndex& line_index() { return lines; }
+
+    void advance();
+    void advance_to(size_t new_position);
     void reload();
 
-    Token get_token(const std::string& code);
-    std::string get_word(const std::string& code);
+    Token get_token();
+    size_t get_word();
+
+    char cur_char() const { return position < length ? code[position] : '\0'; }
 
     bool is_empty(char c) const { return c == ' ' || c == '\n' || c == '\t'; }
     bool is_digit(char c) const { return c >= '0' && c <= '9'; }
     bool is_valid_for_naming(char c) const { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';}
     bool is_number(const std::string& s);
+
+    // Keyword recognition is resolved by length first, then by the first
+    // character, so a plain identifier costs at most one comparison.
+    // Returns Token::STRING for anything that isn't a keyword.
+    static constexpr int keyword_type(const char* s, size_t len)
+    {
+        return len == 2 ? (word_equals(s, "if", 2) ? Token::IF : Token::STRING) :
+            len == 3 ? (s[0] == 'i' ? (word_equals(s, "int", 3) ? Token::INTTYPE : Token::STRING) :
+                s[0] == 'f' ? (word_equals(s, "for", 3) ? Token::FOR : Token::STRING) : Token::STRING) :
+            len == 4 ? (word_equals(s, "else", 4) ? Token::ELSE : Token::STRING) :
+            len == 5 ? (s[0] == 'f' ? (word_equals(s, "float", 5) ? Token::FLOATTYPE : Token::STRING) :
+                s[0] == 'w' ? (word_equals(s, "while", 5) ? Token::WHILE : Token::STRING) :
+                s[0] == 'p' ? (word_equals(s, "print", 5) ? Token::PRINT : Token::STRING) : Token::STRING) :
+            Token::STRING;
+    }
+private:
+    static constexpr bool word_equals(const char* s, const char* word, size_t len)
+    {
+        return len == 0 || (*s == *word && word_equals(s + 1, word + 1, len - 1));
+    }
 };
 
 
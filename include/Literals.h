@@ -0,0 +1,23 @@
+#ifndef LITERALS_H
+#define LITERALS_H
+
+#include <cstddef>
+
+// Number literal parsing straight out of the source buffer. Nothing here
+// allocates, throws or depends on the current locale.
+
+enum LiteralStatus
+{
+    LITERAL_OK = 0,
+    LITERAL_OVERFLOW, // doesn't fit into the target type
+    LITERAL_INVALID   // not a literal at all
+};
+
+// [0-9]+
+LiteralStatus parse_int_literal(const char* begin, const char* end, int& out);
+
+// [0-9]* '.' [0-9]*, with at least one digit. The result is correctly
+// rounded (round half to even) for any number of digits.
+LiteralStatus parse_float_literal(const char* begin, const char* end, float& out);
+
+#endif /* LITERALS_H */
@@ -1,6 +1,8 @@
 #ifndef NODES_H
 #define NODES_H
 
+#include <AstArena.h>
+
 #include <memory>
 #include <iostream>
 #include <cmath> // for abs()
@@ -50,7 +52,7 @@ DECL_TYPE(VOID);
 class Node 
 {
 public:
-    Node(int type) : type(type) {}
+    Node(int type, int valtype = Type::VOID) : type(type), valtype(valtype), runs_as(type), quickened(false) {}
 
     virtual bool is_same(const Node* other) 
     { 
@@ -69,6 +71,18 @@ public:
 
     int type;
 
+    // Type::Types of the value an expression gives, Type::VOID for
+    // statements. Arithmetic on integers only stays integer, division
+    // always gives a float.
+    int valtype;
+
+    // What the tree walker runs the node as: type, or the specialized form
+    // it rewrote the node into the first time the node ran, see
+    // Interpreter::quicken(). Other engines only read type. As running a
+    // tree rewrites it, one tree shouldn't be walked by two threads at once.
+    mutable int runs_as;
+    mutable bool quickened;
+
     enum Types
     {
         SUM = 0,
@@ -92,20 +106,27 @@ public:
         EQUALS,
         GREATER, GOQ,
         LESSER, LOQ,
-        OR, AND
+        OR, AND,
+
+        // Specialized forms, only ever found in runs_as
+        INT_EQUALS,             // comparisons of integer variables and
+        INT_GREATER, INT_GOQ,   // constants
+        INT_LESSER, INT_LOQ,
+        ADD_CONST,              // integer variable + constant
+        INCREMENT               // v = v + constant of an integer variable
     };
 };
 
 class SequenceNode : public Node
 {
 public:
-    SequenceNode(const std::vector<std::shared_ptr<Node>>& nodes = {}, const std::unordered_map<std::string, std::shared_ptr<Type>>& variables = std::unordered_map<std::string, std::shared_ptr<Type>>()) : Node(SEQUENCE), nodes(nodes), variables(variables) {};
+    SequenceNode(const std::vector<Node*>& nodes = {}, const std::unordered_map<std::string, std::shared_ptr<Type>>& variables = std::unordered_map<std::string, std::shared_ptr<Type>>()) : Node(SEQUENCE), nodes(nodes), variables(variables) {};
     ~SequenceNode() { nodes.clear(); };
 
     virtual bool is_same(const Node* other);
     virtual std::string to_string();
 
-    std::vector<std::shared_ptr<Node>> nodes;
+    std::vector<Node*> nodes;
 
     std::unordered_map<std::string, std::shared_ptr<Type>> variables;
 };
@@ -113,7 +134,7 @@ public:
 class DeclareVariableNode : public Node
 {
 public:
-    DeclareVariableNode(Type vartype, std::string name, std::shared_ptr<Node> expression = 0) : Node(DECLVAR), vartype(vartype), name(name), expression(expression) {}
+    DeclareVariableNode(Type vartype, std::string name, Node* expression = 0, int slot = -1) : Node(DECLVAR), vartype(vartype), name(name), expression(expression), slot(slot) {}
 
     virtual bool is_same(const Node* other);
     virtual std::string to_string();
@@ -121,25 +142,32 @@ public:
     Type vartype;
     std::string name;
 
-    std::shared_ptr<Node> expression;
+    Node* expression;
+
+    // Where the interpreter keeps the variable, -1 until resolved. Not
+    // compared by is_same().
+    int slot;
 };
 
 class VariableNode : public Node
 {
 public:
-    VariableNode(std::string name, Type vartype) : Node(VAR), name(name), vartype(vartype) {}
+    VariableNode(std::string name, Type vartype, int slot = -1) : Node(VAR, vartype.type), name(name), vartype(vartype), slot(slot) {}
 
     virtual bool is_same(const Node* other);
     virtual std::string to_string();
 
     std::string name;
     Type vartype;
+
+    // See DeclareVariableNode::slot
+    int slot;
 };
 
 class IntNumNode : public Node
 {
 public:
-    IntNumNode(int val) : Node(INTEGER), val(val) {}
+    IntNumNode(int val) : Node(INTEGER, Type::INTEGER), val(val) {}
 
     virtual bool is_same(const Node* other);
     virtual std::string to_string();
@@ -150,7 +178,7 @@ public:
 class FloatNumNode : public Node
 {
 public:
-    FloatNumNode(float val) : Node(FLOAT), val(val) {}
+    FloatNumNode(float val) : Node(FLOAT, Type::FLOAT), val(val) {}
 
     virtual bool is_same(const Node* other);
     virtual std::string to_string();
@@ -161,27 +189,30 @@ public:
 class BinaryNode : public Node
 {
 public:
-    BinaryNode(int type, std::shared_ptr<Node> left, std::shared_ptr<Node> right, std::string op) : Node(type), left(left), right(right), op(op) {}
+    BinaryNode(int type, Node* left, Node* right, const char* op) : Node(type, value_type(type, left, right)), left(left), right(right), op(op) {}
 
     virtual bool is_same(const Node* other);
     virtual std::string to_string();
 
-    std::shared_ptr<Node> left;
-    std::shared_ptr<Node> right;
+    // What an operator of type gives for those operands
+    static int value_type(int type, const Node* left, const Node* right);
+
+    Node* left;
+    Node* right;
 
-    std::string op;
+    const char* op;
 };
 
 class AssignNode : public BinaryNode
 {
 public:
-    AssignNode(std::shared_ptr<Node> left, std::shared_ptr<Node> right) : BinaryNode(ASSIGN, left, right, "=") {}
+    AssignNode(Node* left, Node* right) : BinaryNode(ASSIGN, left, right, "=") {}
 };
 
 class SumNode : public BinaryNode
 {
 public:
-    SumNode(std::shared_ptr<Node> left, std::shared_ptr<Node> right) : BinaryNode(SUM, left, right, "+") {}
+    SumNode(Node* left, Node* right) : BinaryNode(SUM, left, right, "+") {}
 
     virtual bool is_same(const Node* other);
 };
@@ -189,13 +220,13 @@ public:
 class SubtractNode : public BinaryNode
 {
 public:
-    SubtractNode(std::shared_ptr<Node> left, std::shared_ptr<Node> right) : BinaryNode(SUBTRACT, left, right, "-") {}
+    SubtractNode(Node* left, Node* right) : BinaryNode(SUBTRACT, left, right, "-") {}
 };
 
 class MultiplicationNode : public BinaryNode
 {
 public:
-    MultiplicationNode(std::shared_ptr<Node> left, std::shared_ptr<Node> right) : BinaryNode(MULTIPLICATION, left, right, "*") {}
+    MultiplicationNode(Node* left, Node* right) : BinaryNode(MULTIPLICATION, left, right, "*") {}
 
     virtual bool is_same(const Node* other);
 };
@@ -203,102 +234,102 @@ public:
 class DivisionNode : public BinaryNode
 {
 public:
-    DivisionNode(std::shared_ptr<Node> left, std::shared_ptr<Node> right) : BinaryNode(DIVISION, left, right, "/") {}
+    DivisionNode(Node* left, Node* right) : BinaryNode(DIVISION, left, right, "/") {}
 };
 
 class EqualsNode : public BinaryNode
 {
 public:
-    EqualsNode(std::shared_ptr<Node> left, std::shared_ptr<Node> right) : BinaryNode(EQUALS, left, right, "=") {}
+    EqualsNode(Node* left, Node* right) : BinaryNode(EQUALS, left, right, "=") {}
 };
 
 class GreaterNode : public BinaryNode
 {
 public:
-    GreaterNode(std::shared_ptr<Node> left, std::shared_ptr<Node> right) : BinaryNode(GREATER, left, right, ">") {}
+    GreaterNode(Node* left, Node* right) : BinaryNode(GREATER, left, right, ">") {}
 };
 
 class LesserNode : public BinaryNode
 {
 public:
-    LesserNode(std::shared_ptr<Node> left, std::shared_ptr<Node> right) : BinaryNode(LESSER, left, right, "<") {}
+    LesserNode(Node* left, Node* right) : BinaryNode(LESSER, left, right, "<") {}
 };
 
 class GOQNode : public BinaryNode
 {
 public:
-    GOQNode(std::shared_ptr<Node> left, std::shared_ptr<Node> right) : BinaryNode(GOQ, left, right, ">=") {}
+    GOQNode(Node* left, Node* right) : BinaryNode(GOQ, left, right, ">=") {}
 };
 
 class LOQNode : public BinaryNode
 {
 public:
-    LOQNode(std::shared_ptr<Node> left, std::shared_ptr<Node> right) : BinaryNode(LOQ, left, right, "<=") {}
+    LOQNode(Node* left, Node* right) : BinaryNode(LOQ, left, right, "<=") {}
 };
 
 class ORNode : public BinaryNode
 {
 public:
-    ORNode(std::shared_ptr<Node> left, std::shared_ptr<Node> right) : BinaryNode(OR, left, right, "||") {}
+    ORNode(Node* left, Node* right) : BinaryNode(OR, left, right, "||") {}
 };
 
 class ANDNode : public BinaryNode
 {
 public:
-    ANDNode(std::shared_ptr<Node> left, std::shared_ptr<Node> right) : BinaryNode(AND, left, right, "&&") {}
+    ANDNode(Node* left, Node* right) : BinaryNode(AND, left, right, "&&") {}
 };
 
 class PrintNode : public Node
 {
 public:
     PrintNode() : Node(PRINT) {}
-    PrintNode(const std::vector<std::shared_ptr<Node>>& expressions) : Node(PRINT), expressions(expressions) {}
+    PrintNode(const std::vector<Node*>& expressions) : Node(PRINT), expressions(expressions) {}
 
     virtual bool is_same(const Node* other);
     virtual std::string to_string();
 
-    std::vector<std::shared_ptr<Node>> expressions;
+    std::vector<Node*> expressions;
 };
 
 class BranchingNode : public Node
 {
 public:
-    BranchingNode(std::shared_ptr<Node> statement, std::shared_ptr<Node> if_body, std::shared_ptr<Node> else_body = 0) : Node(BRANCHING), statement(statement), if_body(if_body), else_body(else_body) {}
+    BranchingNode(Node* statement, Node* if_body, Node* else_body = 0) : Node(BRANCHING), statement(statement), if_body(if_body), else_body(else_body) {}
 
     virtual bool is_same(const Node* other);
     virtual std::string to_string();
 
-    std::shared_ptr<Node> statement;
-    std::shared_ptr<Node> if_body;
-    std::shared_ptr<Node> else_body;
+    Node* statement;
+    Node* if_body;
+    Node* else_body;
 };
 
 class ForCycleNode : public Node
 {
 public:
-    ForCycleNode(std::shared_ptr<Node> init, std::shared_ptr<Node> condition, std::shared_ptr<Node> step, std::shared_ptr<Node> body) : Node(FORCYCLE),
+    ForCycleNode(Node* init, Node* condition, Node* step, Node* body) : Node(FORCYCLE),
     init(init), condition(condition), step(step), body(body) {}
 
     virtual bool is_same(const Node* other);
     virtual std::string to_string();
 
-    std::shared_ptr<Node> init;
-    std::shared_ptr<Node> condition;
-    std::shared_ptr<Node> step;
-    std::shared_ptr<Node> body;
+    Node* init;
+    Node* condition;
+    Node* step;
+    Node* body;
 };
 
 class WhileCycleNode : public Node
 {
 public:
-    WhileCycleNode(std::shared_ptr<Node> condition, std::shared_ptr<Node> body) : Node(WHILECYCLE), 
+    WhileCycleNode(Node* condition, Node* body) : Node(WHILECYCLE), 
     condition(condition), body(body) {}
 
     virtual bool is_same(const Node* other);
     virtual std::string to_string();
 
-    std::shared_ptr<Node> condition;
-    std::shared_ptr<Node> body;
+    Node* condition;
+    Node* body;
 };
 
 #endif /* NODES_H */
\ No newline at end of file
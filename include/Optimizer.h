@@ -0,0 +1,74 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <Nodes.h>
+
+#include <vector>
+
+// Simplifies a resolved tree before it runs: constant subexpressions are
+// worked out once, x * 1, x - 0 and, for integers, x + 0 and x * 0 lose
+// their operation, and division by a power of two becomes multiplication
+// by its exact reciprocal. Every engine prints, throws and leaves variables
+// behind as it would have for the tree as it was: integers fold in
+// integers, floats in floats, and a division by a constant 0 stays to throw
+// when it runs.
+//
+// Branches whose condition is known take the body that would run, loops
+// that can't start go, empty else bodies are dropped, and so is everything
+// in a sequence after a loop that never ends.
+class Optimizer
+{
+public:
+    // Nodes the pass makes go into arena, the tree's own one
+    explicit Optimizer(AstArena& arena);
+
+    // Rewrites node's children in place and returns what node itself is
+    // replaced by, node when it stays
+    Node* optimize(Node* node);
+
+    // Operations and statements removed so far
+    size_t changes() const { return changed; }
+private:
+    enum Truth
+    {
+        IS_FALSE,
+        IS_TRUE,
+        UNKNOWN
+    };
+
+    // What node is replaced by, 0 when nothing is left to run
+    Node* statement(Node* node);
+
+    // The same where a statement has to stay, an empty sequence for nothing
+    Node* block(Node* node);
+
+    Node* expr(Node* node);
+
+    // What a condition gives every time it runs. Only known when working it
+    // out can't throw.
+    Truth truth(const Node* node) const;
+
+    // A loop whose condition always holds, or a sequence ending in one
+    bool never_ends(const Node* node) const;
+
+    // x op constant, or constant op x, with the identities applied
+    Node* simplify(BinaryNode* node);
+
+    // Node with both operands constant as one constant, 0 when it has to
+    // stay to throw
+    Node* fold(BinaryNode* node);
+
+    // Whether working node out can throw: a variable whose declaration may
+    // not have run yet, a division, or an expression where a condition
+    // should be or the other way round
+    bool may_throw(const Node* node) const;
+
+    AstArena& arena;
+
+    // Slots whose declaration has run on every path to this point
+    std::vector<bool> declared;
+
+    size_t changed;
+};
+
+#endif /* OPTIMIZER_H */
@@ -3,16 +3,22 @@
 
 #include <Lexer.h>
 #include <Nodes.h>
+#include <Resolver.h>
 
 #include <unordered_map>
-#include <string> // for mem_copy()
+#include <string>
+#include <cstring> // for memcpy()
 
 class ParserException
 {
 public:
     ParserException(std::string err = "") : err(err) {}
+    virtual ~ParserException() {}
 
     const std::string& what() const { return err; }
+
+    // Throws a copy of the most derived type
+    virtual void raise() const { throw *this; }
 protected:
     std::string err;
 };
@@ -20,65 +26,177 @@ protected:
 class UnexpectedTokenError : public ParserException
 {
 public:
-    UnexpectedTokenError(Token t, Token expected = Token());
+    UnexpectedTokenError(Token t, SourcePosition pos, Token expected = Token());
+
+    virtual void raise() const { throw *this; }
 };
 
 class UndefinedNameError : public ParserException
 {
 public:
-    UndefinedNameError(Token t) : ParserException("Undefined name \'" + t.sval + "\' at" + std::to_string(t.line) + " line, " + std::to_string(t.chr) + " column") {}
+    UndefinedNameError(Token t, SourcePosition pos) : ParserException("Undefined name \'" + t.to_string() + "\' at " + pos.to_string()) {}
+
+    virtual void raise() const { throw *this; }
 };
 
 class VariableTypeError : public ParserException
 {
 public:
-    VariableTypeError(Type type1, Type type2, Token t) : ParserException("No conversion from " + std::to_string(type1.type) + "type to " + std::to_string(type2.type) + " type at" + std::to_string(t.line) + " line, " + std::to_string(t.chr) + " column") {}
+    VariableTypeError(Type type1, Type type2, SourcePosition pos) : ParserException("No conversion from " + std::to_string(type1.type) + "type to " + std::to_string(type2.type) + " type at " + pos.to_string()) {}
+
+    virtual void raise() const { throw *this; }
 };
 
 class EndOfFileError : public ParserException
 {
 public:
     EndOfFileError() : ParserException("End of file!") {}
+
+    virtual void raise() const { throw *this; }
+};
+
+// Told about the source span of every statement and block as the parser
+// finishes it. Offsets are byte offsets into the source, like Token::offset.
+class ParseListener
+{
+public:
+    virtual ~ParseListener() {}
+
+    // begin is just past the '{', or where the parser started for the
+    // outermost block
+    virtual void enter_block(size_t begin) = 0;
+
+    // end is the offset of the '}', or just past the last token
+    virtual void leave_block(size_t end, SequenceNode* node) = 0;
+
+    // [begin, end) runs from the first token of the statement up to and
+    // including its ';'. node is null for an empty statement. Statements
+    // that don't parse aren't reported.
+    virtual void statement(size_t begin, size_t end, Node* node) = 0;
 };
 
 class Parser
 {
 public:
-    Parser(std::vector<Token> tokens);
+    // lines is used to put line/column numbers into error messages
+    Parser(std::vector<Token> tokens, LineIndex* lines = 0);
+
+    // Tokens are pulled from source as the parser needs them, so only a few
+    // of them are kept in memory at any time
+    Parser(TokenSource& source, LineIndex* lines = 0);
+
+    // Parses straight out of an already lexed buffer, which has to outlive
+    // the parser
+    Parser(const TokenBuffer& tokens, LineIndex* lines = 0);
     ~Parser();
 
-    std::shared_ptr<Node> make_node();
+    // Mistakes in the script don't throw. They are added to
+    // get_diagnostics(), the statement holding them is skipped and parsing
+    // goes on after its ';'. Functions returning a node return null then.
+    Node* make_node();
 
+    // Throws the first diagnostic, once the whole input has been parsed.
+    // The returned pointer keeps the parser's arena, and with it every node
+    // of the tree, alive.
     std::shared_ptr<SequenceNode> make_tree(const std::unordered_map<std::string, std::shared_ptr<Type>>& variables = std::unordered_map<std::string, std::shared_ptr<Type>>());
-    std::shared_ptr<DeclareVariableNode> make_variable();
-    std::shared_ptr<PrintNode> make_print();
-    std::shared_ptr<Node> make_expression(Type type);
-    std::shared_ptr<AssignNode> make_assign();
-    std::shared_ptr<BranchingNode> make_branching();
-    std::shared_ptr<ForCycleNode> make_for_cycle();
-    std::shared_ptr<WhileCycleNode> make_while_cycle();
-
-    std::shared_ptr<Node> logical_expr();
-    std::shared_ptr<Node> logical_term();
-    std::shared_ptr<Node> logical_fact();
-
-    std::shared_ptr<Node> expr();
-    std::shared_ptr<Node> term();
-    std::shared_ptr<Node> fact();
+    SequenceNode* make_sequence(const std::unordered_map<std::string, std::shared_ptr<Type>>& variables = std::unordered_map<std::string, std::shared_ptr<Type>>());
+    DeclareVariableNode* make_variable();
+    PrintNode* make_print();
+    Node* make_expression(Type type);
+    AssignNode* make_assign();
+    BranchingNode* make_branching();
+    ForCycleNode* make_for_cycle();
+    WhileCycleNode* make_while_cycle();
+
+    // Comparisons and logical operators over arithmetic
+    Node* logical_expr();
+    // Arithmetic only
+    Node* expr();
 
     void advance();
 
-    Type get_var(const std::string& name) const;
+    // false when name isn't declared
+    bool get_var(const std::string& name, Type& out) const;
+
+    // Every error found so far, in source order
+    const std::vector<std::shared_ptr<ParserException>>& get_diagnostics() const { return diagnostics; }
+
+    void set_listener(ParseListener* listener) { this->listener = listener; }
+
+    // Nodes are allocated here, a new arena is made for every parser
+    const std::shared_ptr<AstArena>& get_arena() const { return arena; }
+    void set_arena(const std::shared_ptr<AstArena>& arena) { this->arena = arena; }
+
+    // Gives variables their slots as they are parsed, a new resolver is
+    // made for every parser
+    const std::shared_ptr<Resolver>& get_resolver() const { return resolver; }
+    void set_resolver(const std::shared_ptr<Resolver>& resolver) { this->resolver = resolver; }
+
+    // false once every token has been consumed
+    bool has_token() const { return position < tokens->size(); }
 private:
-    const Token& cur_token() const { return tokens[position]; }
-    const std::shared_ptr<SequenceNode> cur_sequence_node() const { return sequence_nodes.front(); }
+    // Past the last token these are an EMPTY token just after it
+    Token cur_token() const { return has_token() ? tokens->at(position) : Token(Token::EMPTY, last_offset + 1); }
+    int cur_type() const { return has_token() ? tokens->type(position) : int(Token::EMPTY); }
+
+    bool fill();
+    SequenceNode* cur_sequence_node() const { return sequence_nodes.front(); }
+
+    SourcePosition locate(const Token& t) const { return lines ? lines->locate(t.offset) : SourcePosition(t.offset); }
+
+    // Precedence climbing over the binary operator table in Parser.cpp.
+    // Operators binding looser than lowest end the expression, also inside
+    // parentheses.
+    Node* binary(int min_precedence, int lowest);
+    Node* operand(int lowest);
+
+    // Only the first error of a statement is kept, the rest usually
+    // follow from it
+    template <class Error>
+    void error(const Error& e)
+    {
+        if (!recovering)
+        {
+            diagnostics.push_back(std::make_shared<Error>(e));
+        }
+
+        recovering = true;
+    }
+
+    void unexpected(int expected_type = Token::EMPTY);
+
+    // Skips the rest of a broken statement, up to its ';' or the '}' of
+    // the block around it
+    void synchronize();
+
+    bool expect_token(int token_type);
+
+    std::unique_ptr<TokenSource> owned_source;
+    TokenSource* source;
+
+    // Tokens pulled from source are parsed in batches of WINDOW_SIZE
+    static const size_t WINDOW_SIZE = 256;
+
+    TokenBuffer window;
+
+    const TokenBuffer* tokens;
+    size_t position;
+    std::vector<SequenceNode*> sequence_nodes;
+
+    std::shared_ptr<AstArena> arena;
+    std::shared_ptr<Resolver> resolver;
+
+    LineIndex* lines;
+
+    ParseListener* listener;
+
+    // Offset of the last consumed token
+    size_t last_offset;
 
-    void expect_tokens(const std::vector<int>& tokens_types);
-    Token expect_token(int token_type);
+    // Set by error() until the broken statement has been skipped
+    bool recovering;
 
-    int position;
-    std::vector<Token> tokens;
-    std::vector<std::shared_ptr<SequenceNode>> sequence_nodes;
+    std::vector<std::shared_ptr<ParserException>> diagnostics;
 
     enum VariableTypes
     {
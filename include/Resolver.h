@@ -0,0 +1,28 @@
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+#include <Nodes.h>
+
+#include <string>
+#include <unordered_map>
+
+// Numbers variables for the interpreter. All variables share one scope at
+// run time, so every name gets a single slot in one flat frame and the
+// interpreter reaches a variable by indexing instead of hashing its name.
+class Resolver
+{
+public:
+    // Slot of name, a new one if the name hasn't been seen
+    int slot(const std::string& name);
+
+    // Gives every variable under node its slot, for trees that weren't made
+    // by a Parser
+    void resolve(Node* node);
+
+    // Slots handed out so far
+    size_t size() const { return slots.size(); }
+private:
+    std::unordered_map<std::string, int> slots;
+};
+
+#endif /* RESOLVER_H */
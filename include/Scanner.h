@@ -0,0 +1,32 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <cstddef>
+
+// Character class scanners used by the Lexer. Each one returns a pointer to
+// the first character in [begin, end) that is outside of its class, or end.
+// They classify 16 (SSE2) or 32 (AVX2) bytes per step when the CPU allows it.
+
+enum ScanLevel
+{
+    SCAN_SCALAR = 0,
+    SCAN_SSE2,
+    SCAN_AVX2
+};
+
+const char* scan_whitespace(const char* begin, const char* end);
+const char* scan_identifier(const char* begin, const char* end);
+const char* scan_digits(const char* begin, const char* end);
+
+// Number of occurrences of c in [begin, end)
+size_t count_char(const char* begin, const char* end, char c);
+
+// Best level supported by this CPU, picked once at startup
+ScanLevel best_scan_level();
+
+ScanLevel scan_level();
+
+// Clamped to best_scan_level(). Meant for benchmarks and tests.
+void set_scan_level(ScanLevel level);
+
+#endif /* SCANNER_H */
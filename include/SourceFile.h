@@ -0,0 +1,49 @@
+#ifndef SOURCEFILE_H
+#define SOURCEFILE_H
+
+#include <string>
+#include <cstddef>
+
+class SourceFileException
+{
+public:
+    SourceFileException(const std::string& err = "") : err(err) {}
+
+    const std::string& what() const { return err; }
+protected:
+    std::string err;
+};
+
+// Read-only memory mapping of a script file. The Lexer reads straight out of
+// the mapping, so the file is never copied into a std::string.
+class SourceFile
+{
+public:
+    SourceFile();
+    explicit SourceFile(const std::string& path);
+    ~SourceFile();
+
+    void open(const std::string& path);
+    void close();
+
+    bool is_open() const { return opened; }
+
+    const char* data() const { return begin; }
+    size_t size() const { return length; }
+private:
+    SourceFile(const SourceFile& other);
+    SourceFile& operator=(const SourceFile& other);
+
+    const char* begin;
+    size_t length;
+    bool opened;
+
+#ifdef _WIN32
+    void* file_handle;
+    void* mapping_handle;
+#else
+    int fd;
+#endif
+};
+
+#endif /* SOURCEFILE_H */
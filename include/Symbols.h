@@ -0,0 +1,44 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+// Process-wide identifier table. Every distinct name is stored once and
+// tokens refer to it by a small integer id, so lexing an identifier that
+// was already seen does no heap allocation.
+class SymbolTable
+{
+public:
+    // Private tables are only used by lexer threads, whose ids are
+    // translated into global() ones afterwards
+    SymbolTable();
+
+    static SymbolTable& global();
+
+    int intern(const char* s, size_t len);
+    int intern(const std::string& s) { return intern(s.data(), s.length()); }
+
+    // References stay valid for the lifetime of the table
+    const std::string& name(int id) const;
+
+    size_t size() const;
+private:
+    SymbolTable(const SymbolTable& other);
+    SymbolTable& operator=(const SymbolTable& other);
+
+    static size_t hash(const char* s, size_t len);
+
+    void grow();
+
+    std::deque<std::string> names;
+    std::vector<size_t> hashes;
+
+    std::vector<int> slots; // open addressing, id + 1, 0 is empty
+
+    mutable std::mutex mutex;
+};
+
+#endif /* SYMBOLS_H */
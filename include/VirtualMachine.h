@@ -0,0 +1,32 @@
+#ifndef VIRTUAL_MACHINE_H
+#define VIRTUAL_MACHINE_H
+
+#include <Bytecode.h>
+#include <Interpreter.h>
+
+#include <string>
+#include <vector>
+
+// Runs a Program. Registers are Values, the variable registers start out as
+// frame has them and go back into it when the program stops, also when it
+// throws.
+class VirtualMachine
+{
+public:
+    void run(const Program& program, Frame& frame);
+
+    // How this build dispatches instructions, "threaded" or "switch"
+    static const char* dispatch();
+private:
+    void execute(const Program& program);
+
+    // Puts the declared variables back into frame
+    void store(const Program& program, Frame& frame) const;
+
+    std::vector<Value> registers;
+
+    // The line print() is putting together
+    std::string out;
+};
+
+#endif /* VIRTUAL_MACHINE_H */
@@ -0,0 +1,26 @@
+#include <AstArena.h>
+
+AstArena::AstArena() : current(0), end(0), used(0)
+{
+
+}
+
+AstArena::~AstArena()
+{
+    for (size_t i = destructors.size(); i-- > 0;)
+    {
+        destructors[i].second(destructors[i].first);
+    }
+}
+
+void* AstArena::allocate_slow(size_t size, size_t align)
+{
+    size_t block_size = size + align > BLOCK_SIZE ? size + align : BLOCK_SIZE;
+
+    blocks.push_back(std::unique_ptr<char[]>(new char[block_size]));
+
+    current = blocks.back().get();
+    end = current + block_size;
+
+    return allocate(size, align);
+}
@@ -0,0 +1,642 @@
+#include <Bytecode.h>
+#include <Interpreter.h>
+
+#include <cstring>
+
+// Until compile() knows how many variables and temporaries there are,
+// temporaries and constants are numbered apart with these bits set
+static const uint32_t TEMPORARY = 0x40000000;
+static const uint32_t CONSTANT = 0x80000000;
+
+static_assert(sizeof(Instruction) == 16, "Instruction is meant to stay 16 bytes");
+
+BytecodeCompiler::BytecodeCompiler() : temporaries(0), max_temporaries(0)
+{
+
+}
+
+Program BytecodeCompiler::compile(const Node* root)
+{
+    program = Program();
+    declared.clear();
+    temporaries = max_temporaries = 0;
+    constant_ids.clear();
+
+    if (root)
+    {
+        statement(root);
+    }
+
+    emit(Instruction::HALT, 0);
+
+    uint32_t first_constant = program.variables + max_temporaries;
+
+    program.registers = first_constant + uint32_t(program.constants.size());
+
+    for (size_t i = 0; i < program.code.size(); i++)
+    {
+        uint32_t* operands[] = { &program.code[i].dst, &program.code[i].a, &program.code[i].b };
+
+        for (int j = 0; j < 3; j++)
+        {
+            uint32_t& operand = *operands[j];
+
+            if (operand & CONSTANT)
+            {
+                operand = first_constant + (operand & ~CONSTANT);
+            }
+            else if (operand & TEMPORARY)
+            {
+                operand = program.variables + (operand & ~TEMPORARY);
+            }
+        }
+    }
+
+    return program;
+}
+
+void BytecodeCompiler::statement(const Node* node)
+{
+    if (!node)
+    {
+        return;
+    }
+
+    // Temporaries only live through one statement
+    uint32_t first_temporary = temporaries;
+
+    switch (node->type)
+    {
+    case Node::SEQUENCE:
+    {
+        const SequenceNode* sn = static_cast<const SequenceNode*>(node);
+
+        for (size_t i = 0; i < sn->nodes.size(); i++)
+        {
+            statement(sn->nodes[i]);
+        }
+    }
+        break;
+    case Node::DECLVAR:
+    {
+        const DeclareVariableNode* dvn = static_cast<const DeclareVariableNode*>(node);
+
+        if (!dvn->vartype.is_num())
+        {
+            throw InterpreterException("Not number variable");
+        }
+
+        uint32_t v = slot(dvn->slot, dvn->name);
+
+        // The value is worked out before the variable exists, so it can't
+        // see itself
+        if (dvn->expression)
+        {
+            expr_into(dvn->expression, dvn->vartype.type, v);
+        }
+        else
+        {
+            emit(Instruction::MOVE, v, constant(dvn->vartype.type, 0));
+        }
+
+        emit(Instruction::DECLARE, v, uint32_t(dvn->vartype.type));
+
+        declared[v] = true;
+    }
+        break;
+    case Node::ASSIGN:
+    {
+        const AssignNode* an = static_cast<const AssignNode*>(node);
+
+        if (an->left->type != Node::VAR)
+        {
+            throw InterpreterException("not implemented err::run_assign()");
+        }
+
+        const VariableNode* vn = static_cast<const VariableNode*>(an->left);
+
+        if (!vn->vartype.is_num())
+        {
+            throw InterpreterException("Not number variable");
+        }
+
+        expr_into(an->right, vn->vartype.type, variable(vn));
+    }
+        break;
+    case Node::PRINT:
+    {
+        const PrintNode* pn = static_cast<const PrintNode*>(node);
+
+        for (size_t i = 0; i < pn->expressions.size(); i++)
+        {
+            const Node* e = pn->expressions[i];
+
+            if (e->valtype == Type::INTEGER)
+            {
+                emit(Instruction::PRINT_I, 0, expr(e, Type::INTEGER));
+            }
+            else if (e->valtype == Type::FLOAT)
+            {
+                emit(Instruction::PRINT_F, 0, expr(e, Type::FLOAT));
+            }
+            else
+            {
+                emit(Instruction::PRINT_SPACE, 0);
+            }
+        }
+
+        emit(Instruction::PRINT_LINE, 0);
+    }
+        break;
+    case Node::BRANCHING:
+    {
+        const BranchingNode* bn = static_cast<const BranchingNode*>(node);
+
+        std::vector<size_t> to_else;
+        branch_false(bn->statement, to_else);
+
+        std::vector<bool> before = declared;
+
+        statement(bn->if_body);
+
+        declared = before;
+
+        if (bn->else_body)
+        {
+            size_t to_end = emit(Instruction::JUMP, 0);
+
+            patch(to_else, here());
+            statement(bn->else_body);
+            patch(std::vector<size_t>(1, to_end), here());
+
+            declared = before;
+        }
+        else
+        {
+            patch(to_else, here());
+        }
+    }
+        break;
+    case Node::FORCYCLE:
+    case Node::WHILECYCLE:
+    {
+        const Node* condition;
+        const Node* body;
+        const Node* step = 0;
+
+        if (node->type == Node::FORCYCLE)
+        {
+            const ForCycleNode* fcn = static_cast<const ForCycleNode*>(node);
+
+            statement(fcn->init);
+
+            condition = fcn->condition;
+            body = fcn->body;
+            step = fcn->step;
+        }
+        else
+        {
+            const WhileCycleNode* wcn = static_cast<const WhileCycleNode*>(node);
+
+            condition = wcn->condition;
+            body = wcn->body;
+        }
+
+        // The condition goes after the body, so an iteration takes one
+        // conditional jump and nothing else
+        size_t to_condition = emit(Instruction::JUMP, 0);
+        size_t loop = here();
+
+        std::vector<bool> before = declared;
+
+        statement(body);
+        statement(step);
+
+        declared = before;
+
+        patch(std::vector<size_t>(1, to_condition), here());
+
+        if (condition)
+        {
+            std::vector<size_t> to_loop;
+            branch_true(condition, to_loop);
+            patch(to_loop, loop);
+        }
+        else
+        {
+            emit(Instruction::JUMP, uint32_t(loop));
+        }
+    }
+        break;
+    default:
+        break;
+    }
+
+    temporaries = first_temporary;
+}
+
+uint32_t BytecodeCompiler::expr(const Node* node, int type)
+{
+    switch (node->type)
+    {
+    case Node::INTEGER:
+    {
+        int value = static_cast<const IntNumNode*>(node)->val;
+
+        if (type == Type::INTEGER)
+        {
+            return constant(Type::INTEGER, value);
+        }
+
+        float f = float(value);
+        int32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+
+        return constant(Type::FLOAT, bits);
+    }
+    case Node::FLOAT:
+    {
+        float value = static_cast<const FloatNumNode*>(node)->val;
+
+        if (type == Type::INTEGER)
+        {
+            return constant(Type::INTEGER, int(value));
+        }
+
+        int32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        return constant(Type::FLOAT, bits);
+    }
+    case Node::VAR:
+        if (node->valtype == type)
+        {
+            return variable(node);
+        }
+        break;
+    }
+
+    uint32_t t = temporary();
+
+    expr_into(node, type, t);
+
+    return t;
+}
+
+void BytecodeCompiler::expr_into(const Node* node, int type, uint32_t dst)
+{
+    if (node->type == Node::INTEGER || node->type == Node::FLOAT)
+    {
+        emit(Instruction::MOVE, dst, expr(node, type));
+
+        return;
+    }
+
+    if (!Type(node->valtype).is_num())
+    {
+        // Comparisons inside arithmetic, the tree walker fails on them
+        // when it gets there
+        fail("Unknown exception");
+
+        return;
+    }
+
+    if (node->valtype != type)
+    {
+        if (type == Type::INTEGER)
+        {
+            emit(Instruction::F2I, dst, expr(node, Type::FLOAT));
+        }
+        else
+        {
+            emit(Instruction::I2F, dst, expr(node, Type::INTEGER));
+        }
+
+        return;
+    }
+
+    bool ints = type == Type::INTEGER;
+
+    switch (node->type)
+    {
+    case Node::VAR:
+        emit(Instruction::MOVE, dst, variable(node));
+        break;
+    case Node::SUM:
+    case Node::SUBTRACT:
+    case Node::MULTIPLICATION:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        uint32_t op;
+
+        switch (node->type)
+        {
+        case Node::SUM:
+            op = ints ? Instruction::ADD_I : Instruction::ADD_F;
+            break;
+        case Node::SUBTRACT:
+            op = ints ? Instruction::SUB_I : Instruction::SUB_F;
+            break;
+        default:
+            op = ints ? Instruction::MUL_I : Instruction::MUL_F;
+            break;
+        }
+
+        uint32_t a = expr(bn->left, type);
+        uint32_t b = expr(bn->right, type);
+
+        emit(op, dst, a, b);
+    }
+        break;
+    case Node::DIVISION:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        // The right side first, as in Interpreter::calc_expr(), which also
+        // checks it for 0 before it looks at the left side
+        uint32_t b = expr(bn->right, Type::FLOAT);
+
+        if (may_throw(bn->left))
+        {
+            emit(Instruction::NONZERO_F, 0, b);
+        }
+
+        uint32_t a = expr(bn->left, Type::FLOAT);
+
+        emit(Instruction::DIV_F, dst, a, b);
+    }
+        break;
+    default:
+        fail("Unknown exception");
+        break;
+    }
+}
+
+bool BytecodeCompiler::may_throw(const Node* node) const
+{
+    switch (node->type)
+    {
+    case Node::INTEGER:
+    case Node::FLOAT:
+        return false;
+    case Node::VAR:
+    {
+        int slot = static_cast<const VariableNode*>(node)->slot;
+
+        return slot < 0 || size_t(slot) >= declared.size() || !declared[slot];
+    }
+    case Node::SUM:
+    case Node::SUBTRACT:
+    case Node::MULTIPLICATION:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        return may_throw(bn->left) || may_throw(bn->right);
+    }
+    default:
+        return true;
+    }
+}
+
+void BytecodeCompiler::branch_false(const Node* node, std::vector<size_t>& jumps)
+{
+    switch (node->type)
+    {
+    case Node::AND:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        branch_false(bn->left, jumps);
+
+        // The right side doesn't always run, a CHECK in it proves nothing
+        std::vector<bool> before = declared;
+        branch_false(bn->right, jumps);
+        declared = before;
+    }
+        break;
+    case Node::OR:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        std::vector<size_t> to_true;
+        branch_true(bn->left, to_true);
+
+        std::vector<bool> before = declared;
+        branch_false(bn->right, jumps);
+        declared = before;
+        patch(to_true, here());
+    }
+        break;
+    case Node::EQUALS:
+    case Node::GREATER:
+    case Node::GOQ:
+    case Node::LESSER:
+    case Node::LOQ:
+        compare(static_cast<const BinaryNode*>(node), false, jumps);
+        break;
+    default:
+        fail("Unknown exception: calc_logic()");
+        break;
+    }
+}
+
+void BytecodeCompiler::branch_true(const Node* node, std::vector<size_t>& jumps)
+{
+    switch (node->type)
+    {
+    case Node::AND:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        std::vector<size_t> to_false;
+        branch_false(bn->left, to_false);
+
+        std::vector<bool> before = declared;
+        branch_true(bn->right, jumps);
+        declared = before;
+        patch(to_false, here());
+    }
+        break;
+    case Node::OR:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        branch_true(bn->left, jumps);
+
+        std::vector<bool> before = declared;
+        branch_true(bn->right, jumps);
+        declared = before;
+    }
+        break;
+    case Node::EQUALS:
+    case Node::GREATER:
+    case Node::GOQ:
+    case Node::LESSER:
+    case Node::LOQ:
+        compare(static_cast<const BinaryNode*>(node), true, jumps);
+        break;
+    default:
+        fail("Unknown exception: calc_logic()");
+        break;
+    }
+}
+
+void BytecodeCompiler::compare(const BinaryNode* node, bool when, std::vector<size_t>& jumps)
+{
+    bool ints = node->left->valtype == Type::INTEGER && node->right->valtype == Type::INTEGER;
+    int type = ints ? Type::INTEGER : Type::FLOAT;
+
+    uint32_t a = expr(node->left, type);
+    uint32_t b = expr(node->right, type);
+
+    // a > b is b < a and so on. For integers a false < is a >= the other
+    // way around, floats have their own negated jumps because of NaN.
+    uint32_t op;
+    bool swap = node->type == Node::GREATER || node->type == Node::GOQ;
+
+    switch (node->type)
+    {
+    case Node::EQUALS:
+        if (ints)
+        {
+            op = when ? Instruction::JEQ_I : Instruction::JNE_I;
+        }
+        else
+        {
+            op = when ? Instruction::JEQ_F : Instruction::JNEQ_F;
+        }
+        break;
+    case Node::LESSER:
+    case Node::GREATER:
+        if (ints)
+        {
+            op = when ? Instruction::JLT_I : Instruction::JLE_I;
+            swap = when ? swap : !swap;
+        }
+        else
+        {
+            op = when ? Instruction::JLT_F : Instruction::JNLT_F;
+        }
+        break;
+    default: // LOQ, GOQ
+        if (ints)
+        {
+            op = when ? Instruction::JLE_I : Instruction::JLT_I;
+            swap = when ? swap : !swap;
+        }
+        else
+        {
+            op = when ? Instruction::JLE_F : Instruction::JNLE_F;
+        }
+        break;
+    }
+
+    jumps.push_back(swap ? emit(op, 0, b, a) : emit(op, 0, a, b));
+}
+
+uint32_t BytecodeCompiler::variable(const Node* node)
+{
+    const VariableNode* vn = static_cast<const VariableNode*>(node);
+
+    uint32_t v = slot(vn->slot, vn->name);
+
+    if (!declared[v])
+    {
+        emit(Instruction::CHECK, v);
+
+        // Past the CHECK it is declared on this path
+        declared[v] = true;
+    }
+
+    return v;
+}
+
+uint32_t BytecodeCompiler::slot(int slot, const std::string& name)
+{
+    if (slot < 0)
+    {
+        throw InterpreterException("Variable \'" + name + "\' isn't resolved");
+    }
+
+    if (uint32_t(slot) >= program.variables)
+    {
+        program.variables = uint32_t(slot) + 1;
+        program.names.resize(program.variables);
+    }
+
+    // Restoring declared after a block may have cut it short
+    if (size_t(slot) >= declared.size())
+    {
+        declared.resize(slot + 1, false);
+    }
+
+    if (program.names[slot].empty())
+    {
+        program.names[slot] = name;
+    }
+
+    return uint32_t(slot);
+}
+
+uint32_t BytecodeCompiler::constant(int type, int32_t bits)
+{
+    uint64_t key = (uint64_t(type) << 32) | uint32_t(bits);
+
+    std::unordered_map<uint64_t, uint32_t>::const_iterator found = constant_ids.find(key);
+
+    if (found != constant_ids.end())
+    {
+        return found->second;
+    }
+
+    uint32_t id = CONSTANT | uint32_t(program.constants.size());
+
+    program.constants.push_back(bits);
+    program.constant_types.push_back(uint8_t(type));
+    constant_ids[key] = id;
+
+    return id;
+}
+
+uint32_t BytecodeCompiler::temporary()
+{
+    uint32_t id = TEMPORARY | temporaries;
+
+    temporaries++;
+
+    if (temporaries > max_temporaries)
+    {
+        max_temporaries = temporaries;
+    }
+
+    return id;
+}
+
+size_t BytecodeCompiler::emit(uint32_t op, uint32_t dst, uint32_t a, uint32_t b)
+{
+    Instruction i;
+    i.op = op;
+    i.dst = dst;
+    i.a = a;
+    i.b = b;
+
+    program.code.push_back(i);
+
+    return program.code.size() - 1;
+}
+
+void BytecodeCompiler::fail(const std::string& message)
+{
+    emit(Instruction::FAIL, 0, uint32_t(program.messages.size()));
+
+    program.messages.push_back(message);
+}
+
+void BytecodeCompiler::patch(const std::vector<size_t>& jumps, size_t target)
+{
+    for (size_t i = 0; i < jumps.size(); i++)
+    {
+        program.code[jumps[i]].dst = uint32_t(target);
+    }
+}
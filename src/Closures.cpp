@@ -0,0 +1,576 @@
+#include <Closures.h>
+
+#include <iostream>
+
+// Operands of integer operations that are read where the operation is,
+// rather than through a call of their own
+struct IntConstant
+{
+    explicit IntConstant(int value) : value(value) {}
+
+    int operator()(Frame&) const { return value; }
+
+    int value;
+};
+
+struct IntVariable
+{
+    explicit IntVariable(const VariableNode* node) : slot(node->slot), name(node->name) {}
+
+    int operator()(Frame& frame) const { return frame.at(slot, name).ival; }
+
+    int slot;
+    std::string name;
+};
+
+// Wrapping integer operations, see int_add()
+struct IntAdd
+{
+    int operator()(int a, int b) const { return int_add(a, b); }
+};
+
+struct IntSubtract
+{
+    int operator()(int a, int b) const { return int_subtract(a, b); }
+};
+
+struct IntMultiply
+{
+    int operator()(int a, int b) const { return int_multiply(a, b); }
+};
+
+// The left operand is worked out first, as in the tree walker, so errors
+// come out in the same order
+template <class Op, class Result, class Left, class Right>
+static std::function<Result(Frame&)> bind_int(const Left& left, const Right& right)
+{
+    return [left, right](Frame& frame) -> Result
+    {
+        int l = left(frame);
+
+        return Op()(l, right(frame));
+    };
+}
+
+template <class Op, class Result, class Left>
+static std::function<Result(Frame&)> bind_int_right(const Left& left, const Node* node, const ClosureCompiler::IntExpr& right)
+{
+    switch (node->type)
+    {
+    case Node::INTEGER:
+        return bind_int<Op, Result>(left, IntConstant(static_cast<const IntNumNode*>(node)->val));
+    case Node::VAR:
+        return bind_int<Op, Result>(left, IntVariable(static_cast<const VariableNode*>(node)));
+    default:
+        return bind_int<Op, Result>(left, right);
+    }
+}
+
+// An operation on two integer expressions, left and right being node's
+// operands compiled. Constant and variable operands are bound in directly.
+template <class Op, class Result>
+static std::function<Result(Frame&)> int_binary(const BinaryNode* node, const ClosureCompiler::IntExpr& left, const ClosureCompiler::IntExpr& right)
+{
+    switch (node->left->type)
+    {
+    case Node::INTEGER:
+        return bind_int_right<Op, Result>(IntConstant(static_cast<const IntNumNode*>(node->left)->val), node->right, right);
+    case Node::VAR:
+        return bind_int_right<Op, Result>(IntVariable(static_cast<const VariableNode*>(node->left)), node->right, right);
+    default:
+        return bind_int_right<Op, Result>(left, node->right, right);
+    }
+}
+
+template <class Op, class Result>
+static std::function<Result(Frame&)> float_binary(const ClosureCompiler::FloatExpr& left, const ClosureCompiler::FloatExpr& right)
+{
+    return [left, right](Frame& frame) -> Result
+    {
+        float l = left(frame);
+
+        return Op()(l, right(frame));
+    };
+}
+
+// Code that throws what the tree walker would when it gets to this point
+static Closure fail(const std::string& message)
+{
+    return [message](Frame&) { throw InterpreterException(message); };
+}
+
+template <class Result>
+static std::function<Result(Frame&)> fail_with(const std::string& message)
+{
+    return [message](Frame&) -> Result { throw InterpreterException(message); };
+}
+
+// Both sides of a comparison are integers
+static bool int_operands(const BinaryNode* n)
+{
+    return n->left->valtype == Type::INTEGER && n->right->valtype == Type::INTEGER;
+}
+
+// Integers print the way they did when every value was a float
+static void append_int(std::string& out, int value)
+{
+    out += std::to_string(value);
+    out += ".000000";
+}
+
+Closure ClosureCompiler::compile(const Node* root)
+{
+    return statement(root);
+}
+
+Closure ClosureCompiler::statement(const Node* node)
+{
+    if (!node)
+    {
+        return [](Frame&) {};
+    }
+
+    switch (node->type)
+    {
+    case Node::SEQUENCE:
+    {
+        const SequenceNode* sn = static_cast<const SequenceNode*>(node);
+
+        std::vector<Closure> body;
+
+        for (size_t i = 0; i < sn->nodes.size(); i++)
+        {
+            body.push_back(statement(sn->nodes[i]));
+        }
+
+        if (body.size() == 1)
+        {
+            return body[0];
+        }
+
+        return [body](Frame& frame)
+        {
+            for (size_t i = 0; i < body.size(); i++)
+            {
+                body[i](frame);
+            }
+        };
+    }
+    case Node::DECLVAR:
+    {
+        const DeclareVariableNode* dvn = static_cast<const DeclareVariableNode*>(node);
+
+        int slot = dvn->slot;
+        std::string name = dvn->name;
+
+        switch (dvn->vartype.type)
+        {
+        case Type::INTEGER:
+        {
+            if (!dvn->expression)
+            {
+                return [slot, name](Frame& frame) { frame.declare(slot, name, Value(0)); };
+            }
+
+            IntExpr value = calc_int(dvn->expression);
+
+            return [slot, name, value](Frame& frame) { frame.declare(slot, name, Value(value(frame))); };
+        }
+        case Type::FLOAT:
+        {
+            if (!dvn->expression)
+            {
+                return [slot, name](Frame& frame) { frame.declare(slot, name, Value(0.f)); };
+            }
+
+            FloatExpr value = float_expr(dvn->expression);
+
+            return [slot, name, value](Frame& frame) { frame.declare(slot, name, Value(value(frame))); };
+        }
+        default:
+            return fail("Not number variable");
+        }
+    }
+    case Node::ASSIGN:
+    {
+        const AssignNode* an = static_cast<const AssignNode*>(node);
+
+        if (an->left->type != Node::VAR)
+        {
+            return fail("not implemented err::run_assign()");
+        }
+
+        const VariableNode* vn = static_cast<const VariableNode*>(an->left);
+
+        int slot = vn->slot;
+        std::string name = vn->name;
+
+        // The variable is looked up before the value is worked out, as in
+        // Interpreter::run_assign()
+        switch (vn->vartype.type)
+        {
+        case Type::INTEGER:
+        {
+            IntExpr value = calc_int(an->right);
+
+            return [slot, name, value](Frame& frame)
+            {
+                Value& v = frame.at(slot, name);
+                v.ival = value(frame);
+            };
+        }
+        case Type::FLOAT:
+        {
+            FloatExpr value = float_expr(an->right);
+
+            return [slot, name, value](Frame& frame)
+            {
+                Value& v = frame.at(slot, name);
+                v.fval = value(frame);
+            };
+        }
+        default:
+            return [slot, name](Frame& frame)
+            {
+                frame.at(slot, name);
+
+                throw InterpreterException("Not number variable");
+            };
+        }
+    }
+    case Node::PRINT:
+    {
+        const PrintNode* pn = static_cast<const PrintNode*>(node);
+
+        std::vector<PrintItem> items;
+
+        for (size_t i = 0; i < pn->expressions.size(); i++)
+        {
+            items.push_back(print_item(pn->expressions[i]));
+        }
+
+        return [items](Frame& frame)
+        {
+            std::string out;
+
+            for (size_t i = 0; i < items.size(); i++)
+            {
+                items[i](frame, out);
+                out += ' ';
+            }
+
+            out += '\n';
+
+            std::cout << out;
+        };
+    }
+    case Node::BRANCHING:
+    {
+        const BranchingNode* bn = static_cast<const BranchingNode*>(node);
+
+        Condition test = condition(bn->statement);
+        Closure if_body = statement(bn->if_body);
+
+        if (!bn->else_body)
+        {
+            return [test, if_body](Frame& frame)
+            {
+                if (test(frame))
+                {
+                    if_body(frame);
+                }
+            };
+        }
+
+        Closure else_body = statement(bn->else_body);
+
+        return [test, if_body, else_body](Frame& frame)
+        {
+            if (test(frame))
+            {
+                if_body(frame);
+            }
+            else
+            {
+                else_body(frame);
+            }
+        };
+    }
+    case Node::FORCYCLE:
+    {
+        const ForCycleNode* fcn = static_cast<const ForCycleNode*>(node);
+
+        Closure init = statement(fcn->init);
+        Condition test = condition(fcn->condition);
+        Closure step = statement(fcn->step);
+        Closure body = statement(fcn->body);
+
+        return [init, test, step, body](Frame& frame)
+        {
+            init(frame);
+
+            while (test(frame))
+            {
+                body(frame);
+                step(frame);
+            }
+        };
+    }
+    case Node::WHILECYCLE:
+    {
+        const WhileCycleNode* wcn = static_cast<const WhileCycleNode*>(node);
+
+        Condition test = condition(wcn->condition);
+        Closure body = statement(wcn->body);
+
+        return [test, body](Frame& frame)
+        {
+            while (test(frame))
+            {
+                body(frame);
+            }
+        };
+    }
+    default:
+        return [](Frame&) {};
+    }
+}
+
+ClosureCompiler::PrintItem ClosureCompiler::print_item(const Node* node)
+{
+    int type = node->valtype;
+
+    switch (node->type)
+    {
+    case Node::VAR:
+        type = static_cast<const VariableNode*>(node)->vartype.type;
+
+        if (type != Type::INTEGER && type != Type::FLOAT)
+        {
+            return [](Frame&, std::string&) { throw InterpreterException("Not implemented err::run_print()"); };
+        }
+        // fallthrough
+    case Node::INTEGER:
+    case Node::FLOAT:
+    case Node::SUM:
+    case Node::SUBTRACT:
+    case Node::MULTIPLICATION:
+    case Node::DIVISION:
+        if (type == Type::INTEGER)
+        {
+            IntExpr value = calc_int(node);
+
+            return [value](Frame& frame, std::string& out) { append_int(out, value(frame)); };
+        }
+        else
+        {
+            FloatExpr value = float_expr(node);
+
+            return [value](Frame& frame, std::string& out) { out += std::to_string(value(frame)); };
+        }
+    default:
+        return [](Frame&, std::string&) {};
+    }
+}
+
+ClosureCompiler::IntExpr ClosureCompiler::calc_int(const Node* node)
+{
+    if (node->valtype != Type::INTEGER)
+    {
+        FloatExpr value = float_expr(node);
+
+        return [value](Frame& frame) { return int(value(frame)); };
+    }
+
+    return int_expr(node);
+}
+
+ClosureCompiler::IntExpr ClosureCompiler::int_expr(const Node* node)
+{
+    switch (node->type)
+    {
+    case Node::INTEGER:
+        return IntConstant(static_cast<const IntNumNode*>(node)->val);
+    case Node::VAR:
+        return IntVariable(static_cast<const VariableNode*>(node));
+    case Node::SUM:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        return int_binary<IntAdd, int>(bn, int_expr(bn->left), int_expr(bn->right));
+    }
+    case Node::SUBTRACT:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        return int_binary<IntSubtract, int>(bn, int_expr(bn->left), int_expr(bn->right));
+    }
+    case Node::MULTIPLICATION:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        return int_binary<IntMultiply, int>(bn, int_expr(bn->left), int_expr(bn->right));
+    }
+    default:
+        return fail_with<int>("Unknown exception: int_expr()");
+    }
+}
+
+ClosureCompiler::FloatExpr ClosureCompiler::float_expr(const Node* node)
+{
+    switch (node->type)
+    {
+    case Node::INTEGER:
+    {
+        float value = float(static_cast<const IntNumNode*>(node)->val);
+
+        return [value](Frame&) { return value; };
+    }
+    case Node::FLOAT:
+    {
+        float value = static_cast<const FloatNumNode*>(node)->val;
+
+        return [value](Frame&) { return value; };
+    }
+    case Node::SUM:
+    case Node::SUBTRACT:
+    case Node::MULTIPLICATION:
+    {
+        if (node->valtype == Type::INTEGER)
+        {
+            IntExpr value = int_expr(node);
+
+            return [value](Frame& frame) { return float(value(frame)); };
+        }
+
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        FloatExpr left = float_expr(bn->left);
+        FloatExpr right = float_expr(bn->right);
+
+        if (node->type == Node::SUM)
+        {
+            return float_binary<std::plus<float>, float>(left, right);
+        }
+        else if (node->type == Node::SUBTRACT)
+        {
+            return float_binary<std::minus<float>, float>(left, right);
+        }
+
+        return float_binary<std::multiplies<float>, float>(left, right);
+    }
+    case Node::DIVISION:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        FloatExpr left = float_expr(bn->left);
+        FloatExpr right = float_expr(bn->right);
+
+        // The divisor first, it is checked before the left side runs
+        return [left, right](Frame& frame)
+        {
+            float rval = right(frame);
+
+            if (rval == 0.f)
+            {
+                throw ZeroDivisionError();
+            }
+
+            return left(frame) / rval;
+        };
+    }
+    case Node::VAR:
+    {
+        const VariableNode* vn = static_cast<const VariableNode*>(node);
+
+        int slot = vn->slot;
+        std::string name = vn->name;
+
+        switch (vn->vartype.type)
+        {
+        case Type::INTEGER:
+            return [slot, name](Frame& frame) { return float(frame.at(slot, name).ival); };
+        case Type::FLOAT:
+            return [slot, name](Frame& frame) { return frame.at(slot, name).fval; };
+        default:
+            return [slot, name](Frame& frame) -> float
+            {
+                frame.at(slot, name);
+
+                throw InterpreterException("Not number variable");
+            };
+        }
+    }
+    default:
+        return fail_with<float>("Unknown exception");
+    }
+}
+
+ClosureCompiler::Condition ClosureCompiler::condition(const Node* node)
+{
+    switch (node->type)
+    {
+    case Node::AND:
+    case Node::OR:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        Condition left = condition(bn->left);
+        Condition right = condition(bn->right);
+
+        if (node->type == Node::AND)
+        {
+            return [left, right](Frame& frame) { return left(frame) && right(frame); };
+        }
+
+        return [left, right](Frame& frame) { return left(frame) || right(frame); };
+    }
+    case Node::EQUALS:
+    case Node::GREATER:
+    case Node::GOQ:
+    case Node::LESSER:
+    case Node::LOQ:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        if (int_operands(bn))
+        {
+            IntExpr left = int_expr(bn->left);
+            IntExpr right = int_expr(bn->right);
+
+            switch (node->type)
+            {
+            case Node::EQUALS:
+                return int_binary<std::equal_to<int>, bool>(bn, left, right);
+            case Node::GREATER:
+                return int_binary<std::greater<int>, bool>(bn, left, right);
+            case Node::GOQ:
+                return int_binary<std::greater_equal<int>, bool>(bn, left, right);
+            case Node::LESSER:
+                return int_binary<std::less<int>, bool>(bn, left, right);
+            default:
+                return int_binary<std::less_equal<int>, bool>(bn, left, right);
+            }
+        }
+
+        FloatExpr left = float_expr(bn->left);
+        FloatExpr right = float_expr(bn->right);
+
+        switch (node->type)
+        {
+        case Node::EQUALS:
+            return float_binary<std::equal_to<float>, bool>(left, right);
+        case Node::GREATER:
+            return float_binary<std::greater<float>, bool>(left, right);
+        case Node::GOQ:
+            return float_binary<std::greater_equal<float>, bool>(left, right);
+        case Node::LESSER:
+            return float_binary<std::less<float>, bool>(left, right);
+        default:
+            return float_binary<std::less_equal<float>, bool>(left, right);
+        }
+    }
+    default:
+        return fail_with<bool>("Unknown exception: calc_logic()");
+    }
+}
@@ -0,0 +1,495 @@
+#include <Document.h>
+
+#include <algorithm>
+
+// Builds the Block/Statement tree of a parse out of the Parser's callbacks
+class SpanRecorder : public ParseListener
+{
+public:
+    virtual void enter_block(size_t begin)
+    {
+        std::unique_ptr<Document::Block> block(new Document::Block);
+
+        block->begin = begin;
+        block->end = begin;
+        block->node = 0;
+
+        open.push_back(std::move(block));
+        finished.push_back(std::vector<std::unique_ptr<Document::Block>>());
+    }
+
+    virtual void leave_block(size_t end, SequenceNode* node)
+    {
+        std::unique_ptr<Document::Block> block = std::move(open.back());
+
+        open.pop_back();
+        finished.pop_back();
+
+        block->end = end;
+        block->node = node;
+
+        if (open.empty())
+        {
+            result = std::move(block);
+        }
+        else
+        {
+            finished.back().push_back(std::move(block));
+        }
+    }
+
+    virtual void statement(size_t begin, size_t end, Node* node)
+    {
+        Document::Statement s;
+
+        s.begin = begin;
+        s.end = end;
+        s.node = node;
+        s.blocks.swap(finished.back());
+
+        open.back()->statements.push_back(std::move(s));
+    }
+
+    std::unique_ptr<Document::Block> result;
+private:
+    std::vector<std::unique_ptr<Document::Block>> open;
+
+    // Blocks of the statement being parsed at each level
+    std::vector<std::vector<std::unique_ptr<Document::Block>>> finished;
+};
+
+// Declarations made by the statement itself, the ones in its blocks belong
+// to their own statements
+static void own_declarations(const Node* node, std::vector<const DeclareVariableNode*>& out)
+{
+    if (!node)
+    {
+        return;
+    }
+
+    if (node->type == Node::DECLVAR)
+    {
+        out.push_back((const DeclareVariableNode*)node);
+    }
+    else if (node->type == Node::FORCYCLE)
+    {
+        const ForCycleNode* f = (const ForCycleNode*)node;
+
+        own_declarations(f->init, out);
+        own_declarations(f->step, out);
+    }
+}
+
+static void all_declarations(const Document::Statement& statement, std::vector<const DeclareVariableNode*>& out)
+{
+    own_declarations(statement.node, out);
+
+    for (size_t i = 0; i < statement.blocks.size(); i++)
+    {
+        const Document::Block& block = *statement.blocks[i];
+
+        for (size_t j = 0; j < block.statements.size(); j++)
+        {
+            all_declarations(block.statements[j], out);
+        }
+    }
+}
+
+// Every declaration under the statement, with the start of the innermost
+// statement holding it. base is the start of the enclosing block's contents.
+static void anchored_declarations(const Document::Statement& statement, size_t base, std::vector<std::pair<size_t, const DeclareVariableNode*>>& out)
+{
+    size_t begin = base + statement.begin;
+
+    std::vector<const DeclareVariableNode*> own;
+    own_declarations(statement.node, own);
+
+    for (size_t i = 0; i < own.size(); i++)
+    {
+        out.push_back(std::make_pair(begin, own[i]));
+    }
+
+    for (size_t i = 0; i < statement.blocks.size(); i++)
+    {
+        const Document::Block& block = *statement.blocks[i];
+
+        for (size_t j = 0; j < block.statements.size(); j++)
+        {
+            anchored_declarations(block.statements[j], begin + block.begin, out);
+        }
+    }
+}
+
+// The parser reports absolute offsets, the tree keeps relative ones
+static void make_relative(Document::Block& block, size_t base)
+{
+    for (size_t i = 0; i < block.statements.size(); i++)
+    {
+        Document::Statement& s = block.statements[i];
+
+        size_t begin = s.begin;
+
+        s.begin -= base;
+        s.end -= base;
+
+        for (size_t j = 0; j < s.blocks.size(); j++)
+        {
+            Document::Block& inner = *s.blocks[j];
+
+            size_t inner_base = inner.begin;
+
+            inner.begin -= begin;
+            inner.end -= begin;
+
+            make_relative(inner, inner_base);
+        }
+    }
+}
+
+static size_t count_nodes(const std::vector<Document::Statement>& statements, size_t first, size_t last)
+{
+    size_t n = 0;
+
+    for (size_t i = first; i < last; i++)
+    {
+        n += statements[i].node ? 1 : 0;
+    }
+
+    return n;
+}
+
+Document::Document() : last_reparsed(0)
+{
+
+}
+
+void Document::reset(const std::string& text)
+{
+    source = text;
+    lines.reset(source.data(), source.size());
+
+    parse_all();
+}
+
+void Document::edit(size_t offset, size_t removed, const std::string& inserted)
+{
+    offset = std::min(offset, source.size());
+    removed = std::min(removed, source.size() - offset);
+
+    source.replace(offset, removed, inserted);
+    lines.reset(source.data(), source.size());
+
+    if (!root)
+    {
+        parse_all();
+        return;
+    }
+
+    size_t edit_end = offset + removed;
+
+    // Walk down to the innermost block that holds the whole edit. blocks[i]
+    // starts at bases[i] and its statement indices[i] holds blocks[i + 1].
+    std::vector<Block*> blocks(1, root.get());
+    std::vector<size_t> bases(1, 0);
+    std::vector<size_t> indices;
+
+    size_t first = 0;
+    size_t last = 0;
+
+    while (true)
+    {
+        std::vector<Statement>& statements = blocks.back()->statements;
+        size_t base = bases.back();
+
+        // Statements touching [offset, edit_end]
+        first = std::lower_bound(statements.begin(), statements.end(), offset - base, [](const Statement& s, size_t x) { return s.end < x; }) - statements.begin();
+        last = std::upper_bound(statements.begin() + first, statements.end(), edit_end - base, [](size_t x, const Statement& s) { return x < s.begin; }) - statements.begin();
+
+        Block* inner = 0;
+
+        if (last - first == 1)
+        {
+            Statement& s = statements[first];
+
+            for (size_t i = 0; i < s.blocks.size(); i++)
+            {
+                size_t inner_base = base + s.begin + s.blocks[i]->begin;
+
+                if (inner_base <= offset && edit_end <= base + s.begin + s.blocks[i]->end)
+                {
+                    inner = s.blocks[i].get();
+                    bases.push_back(inner_base);
+                }
+            }
+        }
+
+        if (!inner)
+        {
+            break;
+        }
+
+        blocks.push_back(inner);
+        indices.push_back(first);
+    }
+
+    size_t level = blocks.size() - 1;
+
+    ReparseResult result = reparse(*blocks[level], bases[level], first, last, offset, edit_end, inserted.size());
+
+    while (result == TRY_OUTER && level > 0)
+    {
+        level--;
+        result = reparse(*blocks[level], bases[level], indices[level], indices[level] + 1, offset, edit_end, inserted.size());
+    }
+
+    if (result != REPARSED)
+    {
+        parse_all();
+        return;
+    }
+
+    // The blocks around the one parsed again grew or shrank, and everything
+    // after the edit inside them moved
+    for (size_t i = level; i-- > 0;)
+    {
+        Statement& owner = blocks[i]->statements[indices[i]];
+
+        owner.end = owner.end + inserted.size() - removed;
+
+        for (size_t j = 0; j < owner.blocks.size(); j++)
+        {
+            Block& b = *owner.blocks[j];
+
+            if (&b == blocks[i + 1])
+            {
+                b.end = b.end + inserted.size() - removed;
+            }
+            else if (bases[i] + owner.begin + b.begin > edit_end)
+            {
+                b.begin = b.begin + inserted.size() - removed;
+                b.end = b.end + inserted.size() - removed;
+            }
+        }
+
+        std::vector<Statement>& statements = blocks[i]->statements;
+
+        for (size_t j = indices[i] + 1; j < statements.size(); j++)
+        {
+            statements[j].begin = statements[j].begin + inserted.size() - removed;
+            statements[j].end = statements[j].end + inserted.size() - removed;
+        }
+    }
+
+    root->end = source.size();
+}
+
+void Document::parse_all()
+{
+    root_node.reset();
+    root.reset();
+    arena.reset();
+    resolver.reset();
+    declarations.clear();
+
+    last_reparsed = source.size();
+
+    Lexer lexer;
+    TokenBuffer tokens;
+    lexer.make_tokens(source.data(), source.size(), tokens);
+
+    SpanRecorder recorder;
+    Parser parser(tokens, &lines);
+    parser.set_listener(&recorder);
+
+    root_node = parser.make_tree();
+    arena = parser.get_arena();
+    resolver = parser.get_resolver();
+
+    // Like the rest of the pipeline, text after a stray '}' is ignored. It
+    // has no statements to anchor edits to, so every edit parses it all.
+    if (parser.has_token())
+    {
+        return;
+    }
+
+    root = std::move(recorder.result);
+    root->begin = 0;
+    root->end = source.size();
+
+    make_relative(*root, 0);
+
+    for (size_t i = 0; i < root->statements.size(); i++)
+    {
+        add_declarations(root->statements[i], 0);
+    }
+}
+
+Document::ReparseResult Document::reparse(Block& block, size_t base, size_t first, size_t last, size_t edit_begin, size_t edit_end, size_t inserted)
+{
+    std::vector<Statement>& statements = block.statements;
+
+    size_t removed = edit_end - edit_begin;
+
+    // Statements start after ';', '{' or whitespace and end with ';', so the
+    // range can be lexed on its own
+    size_t begin = first < last ? std::min(edit_begin, base + statements[first].begin) : edit_begin;
+    size_t old_end = first < last ? std::max(edit_end, base + statements[last - 1].end) : edit_end;
+    size_t new_end = old_end + inserted - removed;
+
+    TokenBuffer tokens;
+    SpanRecorder recorder;
+    SequenceNode* sequence = 0;
+
+    try
+    {
+        Lexer lexer;
+        lexer.make_tokens(source.data() + begin, new_end - begin, tokens);
+
+        // Types of the names used in the range, as declared before it
+        std::unordered_map<std::string, std::shared_ptr<Type>> variables;
+
+        for (size_t i = 0; i < tokens.size(); i++)
+        {
+            Token t = tokens.at(i);
+
+            t.offset += begin;
+            tokens.set(i, t);
+
+            if (t.type != Token::STRING)
+            {
+                continue;
+            }
+
+            auto found = declarations.find(t.name());
+
+            if (found == declarations.end() || variables.count(t.name()))
+            {
+                continue;
+            }
+
+            const std::vector<Declaration>& list = found->second;
+
+            std::vector<Declaration>::const_iterator d = std::lower_bound(list.begin(), list.end(), begin, [](const Declaration& x, size_t offset) { return x.offset < offset; });
+
+            if (d != list.begin())
+            {
+                variables[t.name()] = std::make_shared<Type>((d - 1)->type);
+            }
+        }
+
+        Parser parser(tokens, &lines);
+        parser.set_listener(&recorder);
+
+        // New nodes go next to the rest of the tree and share its variable
+        // slots. Those of the replaced statements stay there until the next
+        // reset().
+        parser.set_arena(arena);
+        parser.set_resolver(resolver);
+
+        sequence = parser.make_sequence(variables);
+
+        // Doesn't parse on its own, or stopped at a '}' that closes a block
+        // outside of the range
+        if (!parser.get_diagnostics().empty() || parser.has_token())
+        {
+            return TRY_OUTER;
+        }
+    }
+    catch (const LexerException& e)
+    {
+        return TRY_OUTER;
+    }
+
+    std::vector<Statement>& replacement = recorder.result->statements;
+
+    // Later statements were typed against the old declarations
+    std::vector<const DeclareVariableNode*> old_declarations;
+    std::vector<const DeclareVariableNode*> new_declarations;
+
+    for (size_t i = first; i < last; i++)
+    {
+        all_declarations(statements[i], old_declarations);
+    }
+
+    for (size_t i = 0; i < replacement.size(); i++)
+    {
+        all_declarations(replacement[i], new_declarations);
+    }
+
+    if (old_declarations.size() != new_declarations.size())
+    {
+        return TRY_ALL;
+    }
+
+    for (size_t i = 0; i < old_declarations.size(); i++)
+    {
+        const DeclareVariableNode* a = old_declarations[i];
+        const DeclareVariableNode* b = new_declarations[i];
+
+        if (a->name != b->name || a->vartype.type != b->vartype.type || a->vartype.is_const != b->vartype.is_const)
+        {
+            return TRY_ALL;
+        }
+    }
+
+    // Drop the declarations of the old range and move the later ones
+    if (!old_declarations.empty() || inserted != removed)
+    {
+        for (auto& d : declarations)
+        {
+            std::vector<Declaration>& list = d.second;
+
+            list.erase(std::remove_if(list.begin(), list.end(), [&](const Declaration& x) { return x.offset >= begin && x.offset < old_end; }), list.end());
+
+            for (size_t i = 0; i < list.size(); i++)
+            {
+                if (list[i].offset > edit_end)
+                {
+                    list[i].offset = list[i].offset + inserted - removed;
+                }
+            }
+        }
+    }
+
+    for (size_t i = last; i < statements.size(); i++)
+    {
+        statements[i].begin = statements[i].begin + inserted - removed;
+        statements[i].end = statements[i].end + inserted - removed;
+    }
+
+    // Splice the new statements and their nodes in
+    std::vector<Node*>& nodes = block.node->nodes;
+
+    size_t node_index = count_nodes(statements, 0, first);
+
+    nodes.erase(nodes.begin() + node_index, nodes.begin() + node_index + count_nodes(statements, first, last));
+    nodes.insert(nodes.begin() + node_index, sequence->nodes.begin(), sequence->nodes.end());
+
+    make_relative(*recorder.result, base);
+
+    statements.erase(statements.begin() + first, statements.begin() + last);
+    statements.insert(statements.begin() + first, std::make_move_iterator(replacement.begin()), std::make_move_iterator(replacement.end()));
+
+    for (size_t i = 0; i < replacement.size(); i++)
+    {
+        add_declarations(statements[first + i], base);
+    }
+
+    last_reparsed = new_end - begin;
+
+    return REPARSED;
+}
+
+void Document::add_declarations(const Statement& statement, size_t base)
+{
+    std::vector<std::pair<size_t, const DeclareVariableNode*>> found;
+    anchored_declarations(statement, base, found);
+
+    for (size_t i = 0; i < found.size(); i++)
+    {
+        std::vector<Declaration>& list = declarations[found[i].second->name];
+        Declaration d = { found[i].first, found[i].second->vartype };
+
+        list.insert(std::upper_bound(list.begin(), list.end(), d, [](const Declaration& a, const Declaration& b) { return a.offset < b.offset; }), d);
+    }
+}
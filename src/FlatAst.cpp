@@ -0,0 +1,246 @@
+#include <FlatAst.h>
+
+static_assert(sizeof(FlatNode) == 16, "FlatNode is meant to stay 16 bytes");
+
+FlatAst::FlatAst() : root_index(NONE)
+{
+
+}
+
+FlatAst::FlatAst(const Node* root) : root_index(NONE)
+{
+    assign(root);
+}
+
+uint32_t FlatAst::assign(const Node* root)
+{
+    root_index = add(root);
+
+    return root_index;
+}
+
+uint32_t FlatAst::add_list(const std::vector<Node*>& list)
+{
+    uint32_t first = uint32_t(lists.size());
+
+    // Children may add lists of their own, so the slots are taken first
+    lists.resize(lists.size() + list.size());
+
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        uint32_t child = add(list[i]);
+        lists[first + i] = child;
+    }
+
+    return first;
+}
+
+uint32_t FlatAst::add_name(const std::string& name)
+{
+    std::unordered_map<std::string, uint32_t>::const_iterator found = name_ids.find(name);
+
+    if (found != name_ids.end())
+    {
+        return found->second;
+    }
+
+    names.push_back(name);
+    name_ids[name] = uint32_t(names.size() - 1);
+
+    return uint32_t(names.size() - 1);
+}
+
+uint32_t FlatAst::add(const Node* node)
+{
+    if (!node)
+    {
+        return NONE;
+    }
+
+    uint32_t index = uint32_t(nodes.size());
+
+    FlatNode n;
+    n.tag = uint8_t(node->type);
+    n.vartype = uint8_t(node->valtype);
+    n.is_const = 0;
+    n.reserved = 0;
+    n.a = n.b = n.c = NONE;
+
+    nodes.push_back(n);
+
+    switch (node->type)
+    {
+    case Node::INTEGER:
+    {
+        int32_t value = static_cast<const IntNumNode*>(node)->val;
+        memcpy(&n.a, &value, sizeof(value));
+    }
+        break;
+    case Node::FLOAT:
+    {
+        float value = static_cast<const FloatNumNode*>(node)->val;
+        memcpy(&n.a, &value, sizeof(value));
+    }
+        break;
+    case Node::VAR:
+    {
+        const VariableNode* vn = static_cast<const VariableNode*>(node);
+
+        n.vartype = uint8_t(vn->vartype.type);
+        n.is_const = vn->vartype.is_const;
+        n.a = add_name(vn->name);
+        n.c = uint32_t(vn->slot);
+    }
+        break;
+    case Node::DECLVAR:
+    {
+        const DeclareVariableNode* dvn = static_cast<const DeclareVariableNode*>(node);
+
+        n.vartype = uint8_t(dvn->vartype.type);
+        n.is_const = dvn->vartype.is_const;
+        n.a = add_name(dvn->name);
+        n.b = add(dvn->expression);
+        n.c = uint32_t(dvn->slot);
+    }
+        break;
+    case Node::SEQUENCE:
+    {
+        const SequenceNode* sn = static_cast<const SequenceNode*>(node);
+
+        n.a = add_list(sn->nodes);
+        n.b = uint32_t(sn->nodes.size());
+    }
+        break;
+    case Node::PRINT:
+    {
+        const PrintNode* pn = static_cast<const PrintNode*>(node);
+
+        n.a = add_list(pn->expressions);
+        n.b = uint32_t(pn->expressions.size());
+    }
+        break;
+    case Node::BRANCHING:
+    {
+        const BranchingNode* bn = static_cast<const BranchingNode*>(node);
+
+        n.a = add(bn->statement);
+        n.b = add(bn->if_body);
+        n.c = add(bn->else_body);
+    }
+        break;
+    case Node::FORCYCLE:
+    {
+        const ForCycleNode* fcn = static_cast<const ForCycleNode*>(node);
+
+        std::vector<Node*> parts = { fcn->init, fcn->condition, fcn->step, fcn->body };
+
+        n.a = add_list(parts);
+        n.b = uint32_t(parts.size());
+    }
+        break;
+    case Node::WHILECYCLE:
+    {
+        const WhileCycleNode* wcn = static_cast<const WhileCycleNode*>(node);
+
+        n.a = add(wcn->condition);
+        n.b = add(wcn->body);
+    }
+        break;
+    default: // binary operators
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        n.a = add(bn->left);
+        n.b = add(bn->right);
+    }
+        break;
+    }
+
+    nodes[index] = n;
+
+    return index;
+}
+
+static Node* make_binary(AstArena& arena, int tag, Node* left, Node* right)
+{
+    switch (tag)
+    {
+    case Node::ASSIGN:
+        return arena.make<AssignNode>(left, right);
+    case Node::SUM:
+        return arena.make<SumNode>(left, right);
+    case Node::SUBTRACT:
+        return arena.make<SubtractNode>(left, right);
+    case Node::MULTIPLICATION:
+        return arena.make<MultiplicationNode>(left, right);
+    case Node::DIVISION:
+        return arena.make<DivisionNode>(left, right);
+    case Node::EQUALS:
+        return arena.make<EqualsNode>(left, right);
+    case Node::GREATER:
+        return arena.make<GreaterNode>(left, right);
+    case Node::LESSER:
+        return arena.make<LesserNode>(left, right);
+    case Node::GOQ:
+        return arena.make<GOQNode>(left, right);
+    case Node::LOQ:
+        return arena.make<LOQNode>(left, right);
+    case Node::OR:
+        return arena.make<ORNode>(left, right);
+    case Node::AND:
+        return arena.make<ANDNode>(left, right);
+    default:
+        return 0;
+    }
+}
+
+Node* FlatAst::to_tree(AstArena& arena, uint32_t index) const
+{
+    if (index == NONE)
+    {
+        return 0;
+    }
+
+    const FlatNode& n = nodes[index];
+
+    switch (n.tag)
+    {
+    case Node::INTEGER:
+        return arena.make<IntNumNode>(int(int_value(n)));
+    case Node::FLOAT:
+        return arena.make<FloatNumNode>(float_value(n));
+    case Node::VAR:
+        return arena.make<VariableNode>(names[n.a], Type(n.vartype, n.is_const), int(n.c));
+    case Node::DECLVAR:
+        return arena.make<DeclareVariableNode>(Type(n.vartype, n.is_const), names[n.a], to_tree(arena, n.b), int(n.c));
+    case Node::SEQUENCE:
+    case Node::PRINT:
+    {
+        std::vector<Node*> list;
+
+        for (uint32_t i = 0; i < n.b; i++)
+        {
+            list.push_back(to_tree(arena, lists[n.a + i]));
+        }
+
+        if (n.tag == Node::PRINT)
+        {
+            return arena.make<PrintNode>(list);
+        }
+
+        return arena.make<SequenceNode>(list);
+    }
+    case Node::BRANCHING:
+        return arena.make<BranchingNode>(to_tree(arena, n.a), to_tree(arena, n.b), to_tree(arena, n.c));
+    case Node::FORCYCLE:
+    {
+        const uint32_t* parts = &lists[n.a];
+
+        return arena.make<ForCycleNode>(to_tree(arena, parts[0]), to_tree(arena, parts[1]), to_tree(arena, parts[2]), to_tree(arena, parts[3]));
+    }
+    case Node::WHILECYCLE:
+        return arena.make<WhileCycleNode>(to_tree(arena, n.a), to_tree(arena, n.b));
+    default:
+        return make_binary(arena, n.tag, to_tree(arena, n.a), to_tree(arena, n.b));
+    }
+}
@@ -1,8 +1,16 @@
 #include <Interpreter.h>
+#include <VirtualMachine.h>
+#include <Closures.h>
 
-Interpreter::Interpreter()
+#include <type_traits>
+
+static_assert(sizeof(Value) == 8, "Value is meant to stay 8 bytes");
+static_assert(std::is_trivially_copyable<Value>::value, "Value should stay a plain value");
+static_assert(Node::INT_LOQ - Node::INT_EQUALS == Node::LOQ - Node::EQUALS, "INT_ comparisons follow the order of the generic ones");
+
+Interpreter::Interpreter(Engine engine) : engine(engine)
 {
-    namefields.push_back(NameField());
+
 }
 
 Interpreter::~Interpreter()
@@ -12,7 +20,32 @@ Interpreter::~Interpreter()
 
 void Interpreter::run(const Node* node)
 {
-    switch(node->type)
+    if (engine == BYTECODE)
+    {
+        VirtualMachine vm;
+        vm.run(BytecodeCompiler().compile(node), frame);
+
+        return;
+    }
+
+    if (engine == CLOSURES)
+    {
+        ClosureCompiler().compile(node)(frame);
+
+        return;
+    }
+
+    walk(node);
+}
+
+void Interpreter::walk(const Node* node)
+{
+    if (!node->quickened)
+    {
+        quicken(node);
+    }
+
+    switch(node->runs_as)
     {
     case Node::SEQUENCE:
         run_sequence((const SequenceNode*)node);
@@ -23,6 +56,9 @@ void Interpreter::run(const Node* node)
     case Node::ASSIGN:
         run_assign((const AssignNode*)node);
         break;
+    case Node::INCREMENT:
+        run_increment((const AssignNode*)node);
+        break;
     case Node::PRINT:
         run_print((const PrintNode*)node);
         break;
@@ -38,52 +74,89 @@ void Interpreter::run(const Node* node)
     }
 }
 
+// A block doesn't open a scope: every variable has its own slot in the one
+// frame, and a declaration inside a block stays visible after it, as it
+// always has. Entering a block, even a loop body on every iteration, costs
+// nothing beyond running its statements.
 void Interpreter::run_sequence(const SequenceNode* sq)
 {
-    namefields.push_back(get_current_name_field());
-
     for (int i = 0; i < sq->nodes.size(); i++)
     {
-        run(sq->nodes.at(i).get());
+        walk(sq->nodes[i]);
     }
-
-    namefields.pop_back();
 }
 
 void Interpreter::decl_var(const DeclareVariableNode* dvn)
 {
-    std::shared_ptr<Node> expression = dvn->expression;
-    Type type = dvn->vartype;
-    std::string name = dvn->name;
+    const Node* expression = dvn->expression;
+
+    switch(dvn->vartype.type)
+    {
+    case Type::INTEGER:
+        frame.declare(dvn->slot, dvn->name, Value(expression ? calc_int(expression) : 0));
+        break;
+    case Type::FLOAT:
+        frame.declare(dvn->slot, dvn->name, Value(expression ? calc_expr(expression) : 0.f));
+        break;
+    default:
+        throw InterpreterException("Not number variable");
+    }
+}
+
+void Frame::declare(int slot, const std::string& name, Value value)
+{
+    if (slot < 0)
+    {
+        throw InterpreterException("Variable \'" + name + "\' isn't resolved");
+    }
 
-    init_var(name);
+    if (size_t(slot) >= values.size())
+    {
+        values.resize(slot + 1);
+        names.resize(slot + 1);
+    }
 
-    if (expression.get())
+    if (values[slot].tag == Type::VOID)
     {
-        switch(type.type)
-        {
-        case Type::INTEGER:
-            set_var_int_val(name, int(calc_expr(expression.get())));
-            break;
-        case Type::FLOAT:
-            set_var_float_val(name, calc_expr(expression.get()));
-            break;
-        }
+        names[slot] = name;
     }
-    else
+
+    values[slot] = value;
+}
+
+void Frame::undeclared(const std::string& name)
+{
+    throw InterpreterException("Variable \'" + name + "\' is used before its declaration");
+}
+
+const Value* Frame::find(const std::string& name) const
+{
+    for (size_t i = 0; i < names.size(); i++)
     {
-        switch(type.type)
+        if (values[i].tag != Type::VOID && names[i] == name)
         {
-        case Type::INTEGER:
-            set_var_int_val(name, 0);
-            break;
-        case Type::FLOAT:
-            set_var_float_val(name, 0.f);
-            break;
+            return &values[i];
         }
     }
+
+    return 0;
 }
 
+const Value& Interpreter::get_var(const std::string& name) const
+{
+    const Value* v = frame.find(name);
+
+    if (!v)
+    {
+        throw InterpreterException("Variable \'" + name + "\' isn't declared");
+    }
+
+    return *v;
+}
+
+// Left operands are worked out before right ones, as on the other engines,
+// so that errors come out in the same order. Only a division works out its
+// divisor first, on every engine.
 float Interpreter::calc_expr(const Node* node)
 {
     switch(node->type)
@@ -95,28 +168,55 @@ float Interpreter::calc_expr(const Node* node)
         return static_cast<const FloatNumNode*>(node)->val;
         break;
     case Node::SUM:
-        return calc_expr(static_cast<const SumNode*>(node)->left.get()) + calc_expr(static_cast<const SumNode*>(node)->right.get());
+    {
+        if (node->valtype == Type::INTEGER)
+        {
+            return float(int_expr(node));
+        }
+
+        float lval = calc_expr(static_cast<const SumNode*>(node)->left);
+
+        return lval + calc_expr(static_cast<const SumNode*>(node)->right);
+    }
         break;
     case Node::SUBTRACT:
-        return calc_expr(static_cast<const SubtractNode*>(node)->left.get()) - calc_expr(static_cast<const SubtractNode*>(node)->right.get());
+    {
+        if (node->valtype == Type::INTEGER)
+        {
+            return float(int_expr(node));
+        }
+
+        float lval = calc_expr(static_cast<const SubtractNode*>(node)->left);
+
+        return lval - calc_expr(static_cast<const SubtractNode*>(node)->right);
+    }
         break;
     case Node::MULTIPLICATION:
-        return calc_expr(static_cast<const MultiplicationNode*>(node)->left.get()) * calc_expr(static_cast<const MultiplicationNode*>(node)->right.get());
+    {
+        if (node->valtype == Type::INTEGER)
+        {
+            return float(int_expr(node));
+        }
+
+        float lval = calc_expr(static_cast<const MultiplicationNode*>(node)->left);
+
+        return lval * calc_expr(static_cast<const MultiplicationNode*>(node)->right);
+    }
         break;
     case Node::DIVISION:
     {
-        float rval = calc_expr(static_cast<const DivisionNode*>(node)->right.get());
+        float rval = calc_expr(static_cast<const DivisionNode*>(node)->right);
         if (rval == 0.f)
         {
             throw ZeroDivisionError();
         }
-        return calc_expr(static_cast<const SumNode*>(node)->left.get()) / rval;
+        return calc_expr(static_cast<const SumNode*>(node)->left) / rval;
         break;
     }
     case Node::VAR:
     {
         const VariableNode* vn = static_cast<const VariableNode*>(node);
-        Variable v = get_var(vn->name);
+        const Value& v = var(vn->slot, vn->name);
 
         if (vn->vartype.type == Type::INTEGER)
         {
@@ -138,63 +238,312 @@ float Interpreter::calc_expr(const Node* node)
     }
 }
 
-bool Interpreter::calc_logic(const Node* node)
+int Interpreter::calc_int(const Node* node)
+{
+    if (node->valtype != Type::INTEGER)
+    {
+        return int(calc_expr(node));
+    }
+
+    return int_expr(node);
+}
+
+int Interpreter::int_expr(const Node* node)
+{
+    if (!node->quickened)
+    {
+        quicken(node);
+    }
+
+    switch(node->runs_as)
+    {
+    case Node::INTEGER:
+        return static_cast<const IntNumNode*>(node)->val;
+    case Node::ADD_CONST:
+    {
+        const SumNode* n = static_cast<const SumNode*>(node);
+        int left;
+
+        if (int_leaf(n->left, left))
+        {
+            return int_add(left, static_cast<const IntNumNode*>(n->right)->val);
+        }
+
+        node->runs_as = node->type;
+
+        return int_expr(node);
+    }
+    case Node::VAR:
+    {
+        const VariableNode* vn = static_cast<const VariableNode*>(node);
+
+        return var(vn->slot, vn->name).ival;
+    }
+    case Node::SUM:
+    {
+        int lval = int_expr(static_cast<const SumNode*>(node)->left);
+
+        return int_add(lval, int_expr(static_cast<const SumNode*>(node)->right));
+    }
+    case Node::SUBTRACT:
+    {
+        int lval = int_expr(static_cast<const SubtractNode*>(node)->left);
+
+        return int_subtract(lval, int_expr(static_cast<const SubtractNode*>(node)->right));
+    }
+    case Node::MULTIPLICATION:
+    {
+        int lval = int_expr(static_cast<const MultiplicationNode*>(node)->left);
+
+        return int_multiply(lval, int_expr(static_cast<const MultiplicationNode*>(node)->right));
+    }
+    default:
+        throw InterpreterException("Unknown exception: int_expr()");
+    }
+}
+
+// Both sides of a comparison are integers
+static bool int_operands(const BinaryNode* n)
 {
+    return n->left->valtype == Type::INTEGER && n->right->valtype == Type::INTEGER;
+}
+
+// An integer variable or constant
+static bool is_int_leaf(const Node* node)
+{
+    return node->valtype == Type::INTEGER && (node->type == Node::VAR || node->type == Node::INTEGER);
+}
+
+// A variable + an integer constant
+static bool is_add_const(const Node* node)
+{
+    if (node->type != Node::SUM || node->valtype != Type::INTEGER)
+    {
+        return false;
+    }
+
+    const SumNode* n = static_cast<const SumNode*>(node);
+
+    return n->left->type == Node::VAR && n->right->type == Node::INTEGER;
+}
+
+void Interpreter::quicken(const Node* node)
+{
+    node->quickened = true;
+
     switch(node->type)
     {
+    case Node::EQUALS:
+    case Node::GREATER:
+    case Node::GOQ:
+    case Node::LESSER:
+    case Node::LOQ:
+    {
+        const BinaryNode* n = static_cast<const BinaryNode*>(node);
+
+        if (is_int_leaf(n->left) && is_int_leaf(n->right))
+        {
+            node->runs_as = Node::INT_EQUALS + (node->type - Node::EQUALS);
+        }
+    }
+        break;
+    case Node::SUM:
+        if (is_add_const(node))
+        {
+            node->runs_as = Node::ADD_CONST;
+        }
+        break;
+    case Node::ASSIGN:
+    {
+        const AssignNode* n = static_cast<const AssignNode*>(node);
+
+        if (n->left->type == Node::VAR && n->left->valtype == Type::INTEGER && is_add_const(n->right))
+        {
+            const VariableNode* target = static_cast<const VariableNode*>(n->left);
+            const VariableNode* source = static_cast<const VariableNode*>(static_cast<const SumNode*>(n->right)->left);
+
+            if (target->slot == source->slot && target->slot >= 0)
+            {
+                node->runs_as = Node::INCREMENT;
+            }
+        }
+    }
+        break;
+    }
+}
+
+bool Interpreter::int_leaf(const Node* node, int& value)
+{
+    if (node->type == Node::INTEGER)
+    {
+        value = static_cast<const IntNumNode*>(node)->val;
+
+        return true;
+    }
+
+    const Value* v = frame.holding(static_cast<const VariableNode*>(node)->slot, Type::INTEGER);
+
+    if (!v)
+    {
+        return false;
+    }
+
+    value = v->ival;
+
+    return true;
+}
+
+bool Interpreter::calc_logic(const Node* node)
+{
+    if (!node->quickened)
+    {
+        quicken(node);
+    }
+
+    int left, right;
+
+    switch(node->runs_as)
+    {
+    case Node::INT_EQUALS:
+        if (int_leaf(static_cast<const BinaryNode*>(node)->left, left) && int_leaf(static_cast<const BinaryNode*>(node)->right, right))
+        {
+            return left == right;
+        }
+        break;
+    case Node::INT_GREATER:
+        if (int_leaf(static_cast<const BinaryNode*>(node)->left, left) && int_leaf(static_cast<const BinaryNode*>(node)->right, right))
+        {
+            return left > right;
+        }
+        break;
+    case Node::INT_GOQ:
+        if (int_leaf(static_cast<const BinaryNode*>(node)->left, left) && int_leaf(static_cast<const BinaryNode*>(node)->right, right))
+        {
+            return left >= right;
+        }
+        break;
+    case Node::INT_LESSER:
+        if (int_leaf(static_cast<const BinaryNode*>(node)->left, left) && int_leaf(static_cast<const BinaryNode*>(node)->right, right))
+        {
+            return left < right;
+        }
+        break;
+    case Node::INT_LOQ:
+        if (int_leaf(static_cast<const BinaryNode*>(node)->left, left) && int_leaf(static_cast<const BinaryNode*>(node)->right, right))
+        {
+            return left <= right;
+        }
+        break;
     case Node::AND:
     {
         const ANDNode* n = static_cast<const ANDNode*>(node);
 
-        return calc_logic(n->left.get()) && calc_logic(n->right.get());
+        return calc_logic(n->left) && calc_logic(n->right);
     }
         break;
     case Node::OR:
     {
         const ORNode* n = static_cast<const ORNode*>(node);
 
-        return calc_logic(n->left.get()) || calc_logic(n->right.get());
+        return calc_logic(n->left) || calc_logic(n->right);
     }
         break;
     case Node::EQUALS:
     {
         const EqualsNode* n = static_cast<const EqualsNode*>(node);
 
-        return calc_expr(n->left.get()) == calc_expr(n->right.get());
+        if (int_operands(n))
+        {
+            left = int_expr(n->left);
+
+            return left == int_expr(n->right);
+        }
+
+        float lval = calc_expr(n->left);
+
+        return lval == calc_expr(n->right);
     }
         break;
     case Node::GREATER:
     {
         const GreaterNode* n = static_cast<const GreaterNode*>(node);
 
-        return calc_expr(n->left.get()) > calc_expr(n->right.get());
+        if (int_operands(n))
+        {
+            left = int_expr(n->left);
+
+            return left > int_expr(n->right);
+        }
+
+        float lval = calc_expr(n->left);
+
+        return lval > calc_expr(n->right);
     }
         break;
     case Node::GOQ:
     {
         const GOQNode* n = static_cast<const GOQNode*>(node);
 
-        return calc_expr(n->left.get()) >= calc_expr(n->right.get());
+        if (int_operands(n))
+        {
+            left = int_expr(n->left);
+
+            return left >= int_expr(n->right);
+        }
+
+        float lval = calc_expr(n->left);
+
+        return lval >= calc_expr(n->right);
     }
         break;
     case Node::LESSER:
     {
         const LesserNode* n = static_cast<const LesserNode*>(node);
 
-        return calc_expr(n->left.get()) < calc_expr(n->right.get());
+        if (int_operands(n))
+        {
+            left = int_expr(n->left);
+
+            return left < int_expr(n->right);
+        }
+
+        float lval = calc_expr(n->left);
+
+        return lval < calc_expr(n->right);
     }
         break;
     case Node::LOQ:
     {
         const LOQNode* n = static_cast<const LOQNode*>(node);
 
-        return calc_expr(n->left.get()) <= calc_expr(n->right.get());
+        if (int_operands(n))
+        {
+            left = int_expr(n->left);
+
+            return left <= int_expr(n->right);
+        }
+
+        float lval = calc_expr(n->left);
+
+        return lval <= calc_expr(n->right);
     }
         break;
     default:
         throw InterpreterException("Unknown exception: calc_logic()");
         break;
     }
+
+    // An INT_ comparison found a variable not holding an integer
+    node->runs_as = node->type;
+
+    return calc_logic(node);
+}
+
+// Integers print the way they did when every value was a float
+static void append_int(std::string& out, int value)
+{
+    out += std::to_string(value);
+    out += ".000000";
 }
 
 void Interpreter::run_print(const PrintNode* pn)
@@ -203,7 +552,7 @@ void Interpreter::run_print(const PrintNode* pn)
 
     for (int i = 0; i < pn->expressions.size(); i++)
     {
-        Node* n = pn->expressions.at(i).get();
+        Node* n = pn->expressions.at(i);
 
         switch(n->type)
         {
@@ -213,13 +562,24 @@ void Interpreter::run_print(const PrintNode* pn)
         case Node::SUBTRACT:
         case Node::MULTIPLICATION:
         case Node::DIVISION:
-            out += std::to_string(calc_expr(n));
+            if (n->valtype == Type::INTEGER)
+            {
+                append_int(out, calc_int(n));
+            }
+            else
+            {
+                out += std::to_string(calc_expr(n));
+            }
             break;
         case Node::VAR:
         {
             VariableNode* vn = static_cast<VariableNode*>(n);
 
-            if(vn->vartype.type == Type::INTEGER || vn->vartype.type == Type::FLOAT)
+            if (vn->vartype.type == Type::INTEGER)
+            {
+                append_int(out, calc_int(vn));
+            }
+            else if (vn->vartype.type == Type::FLOAT)
             {
                 out += std::to_string(calc_expr(vn));
             }
@@ -241,22 +601,22 @@ void Interpreter::run_print(const PrintNode* pn)
 
 void Interpreter::run_assign(const AssignNode* an)
 {
-    Node* l = an->left.get();
+    Node* l = an->left;
 
     switch (l->type)
     {
     case Node::VAR:
     {
         const VariableNode* vn = static_cast<const VariableNode*>(l);
-        const Variable& v = get_var(vn->name);
+        Value& v = var(vn->slot, vn->name);
 
         if (vn->vartype.type == Type::INTEGER)
         {
-            set_var_int_val(vn->name, int(calc_expr(an->right.get())));
+            v.ival = calc_int(an->right);
         }
         else if (vn->vartype.type == Type::FLOAT)
         {
-            set_var_float_val(vn->name, calc_expr(an->right.get()));
+            v.fval = calc_expr(an->right);
         }
         else
         {
@@ -270,38 +630,357 @@ void Interpreter::run_assign(const AssignNode* an)
     }
 }
 
+void Interpreter::run_increment(const AssignNode* an)
+{
+    const VariableNode* vn = static_cast<const VariableNode*>(an->left);
+    Value* v = frame.holding(vn->slot, Type::INTEGER);
+
+    if (!v)
+    {
+        an->runs_as = an->type;
+        run_assign(an);
+
+        return;
+    }
+
+    v->ival = int_add(v->ival, static_cast<const IntNumNode*>(static_cast<const SumNode*>(an->right)->right)->val);
+}
+
 void Interpreter::run_branching(const BranchingNode* bn)
 {
-    bool val = calc_logic(bn->statement.get());
+    bool val = calc_logic(bn->statement);
 
     if (val)
     {
-        run(bn->if_body.get());
+        walk(bn->if_body);
     }
     else
     {
-        if (bn->else_body.get())
+        if (bn->else_body)
         {
-            run(bn->else_body.get());
+            walk(bn->else_body);
         }
     }
 }
 
 void Interpreter::run_for_cycle(const ForCycleNode* fcn)
 {
-    run(fcn->init.get());
+    walk(fcn->init);
 
-    while(calc_logic(fcn->condition.get()))
+    while(calc_logic(fcn->condition))
     {
-        run(fcn->body.get());
-        run(fcn->step.get());
+        walk(fcn->body);
+        walk(fcn->step);
     }
 }
 
 void Interpreter::run_while_cycle(const WhileCycleNode* wcn)
 {
-    while(calc_logic(wcn->condition.get()))
+    while(calc_logic(wcn->condition))
+    {
+        walk(wcn->body);
+    }
+}
+
+void Interpreter::run(const FlatAst& ast, uint32_t index)
+{
+    const FlatNode& n = ast.at(index);
+
+    switch(n.tag)
+    {
+    case Node::SEQUENCE:
+    {
+        const uint32_t* nodes = ast.children(n);
+
+        for (uint32_t i = 0; i < n.b; i++)
+        {
+            run(ast, nodes[i]);
+        }
+    }
+        break;
+    case Node::DECLVAR:
+    {
+        bool has_value = n.b != FlatAst::NONE;
+
+        switch(n.vartype)
+        {
+        case Type::INTEGER:
+            frame.declare(int(n.c), ast.name(n), Value(has_value ? calc_int(ast, n.b) : 0));
+            break;
+        case Type::FLOAT:
+            frame.declare(int(n.c), ast.name(n), Value(has_value ? calc_expr(ast, n.b) : 0.f));
+            break;
+        default:
+            throw InterpreterException("Not number variable");
+        }
+    }
+        break;
+    case Node::ASSIGN:
+    {
+        const FlatNode& l = ast.at(n.a);
+
+        if (l.tag != Node::VAR)
+        {
+            throw InterpreterException("not implemented err::run_assign()");
+        }
+
+        Value& v = var(int(l.c), ast.name(l));
+
+        if (l.vartype == Type::INTEGER)
+        {
+            v.ival = calc_int(ast, n.b);
+        }
+        else if (l.vartype == Type::FLOAT)
+        {
+            v.fval = calc_expr(ast, n.b);
+        }
+        else
+        {
+            throw InterpreterException("Not number variable");
+        }
+    }
+        break;
+    case Node::PRINT:
+    {
+        const uint32_t* expressions = ast.children(n);
+
+        std::string out;
+
+        for (uint32_t i = 0; i < n.b; i++)
+        {
+            const FlatNode& e = ast.at(expressions[i]);
+
+            switch(e.tag)
+            {
+            case Node::INTEGER:
+            case Node::FLOAT:
+            case Node::SUM:
+            case Node::SUBTRACT:
+            case Node::MULTIPLICATION:
+            case Node::DIVISION:
+            case Node::VAR:
+                if (e.vartype == Type::INTEGER)
+                {
+                    append_int(out, calc_int(ast, expressions[i]));
+                }
+                else if (e.vartype == Type::FLOAT)
+                {
+                    out += std::to_string(calc_expr(ast, expressions[i]));
+                }
+                else
+                {
+                    throw InterpreterException("Not implemented err::run_print()");
+                }
+                break;
+            }
+
+            out += ' ';
+        }
+
+        out += '\n';
+
+        std::cout << out;
+    }
+        break;
+    case Node::BRANCHING:
+        if (calc_logic(ast, n.a))
+        {
+            run(ast, n.b);
+        }
+        else if (n.c != FlatAst::NONE)
+        {
+            run(ast, n.c);
+        }
+        break;
+    case Node::FORCYCLE:
+    {
+        const uint32_t* parts = ast.children(n);
+
+        run(ast, parts[0]);
+
+        while(calc_logic(ast, parts[1]))
+        {
+            run(ast, parts[3]);
+            run(ast, parts[2]);
+        }
+    }
+        break;
+    case Node::WHILECYCLE:
+        while(calc_logic(ast, n.a))
+        {
+            run(ast, n.b);
+        }
+        break;
+    }
+}
+
+float Interpreter::calc_expr(const FlatAst& ast, uint32_t index)
+{
+    const FlatNode& n = ast.at(index);
+
+    switch(n.tag)
+    {
+    case Node::INTEGER:
+        return float(FlatAst::int_value(n));
+    case Node::FLOAT:
+        return FlatAst::float_value(n);
+    case Node::SUM:
+    {
+        if (n.vartype == Type::INTEGER)
+        {
+            return float(int_expr(ast, index));
+        }
+
+        float lval = calc_expr(ast, n.a);
+
+        return lval + calc_expr(ast, n.b);
+    }
+    case Node::SUBTRACT:
+    {
+        if (n.vartype == Type::INTEGER)
+        {
+            return float(int_expr(ast, index));
+        }
+
+        float lval = calc_expr(ast, n.a);
+
+        return lval - calc_expr(ast, n.b);
+    }
+    case Node::MULTIPLICATION:
+    {
+        if (n.vartype == Type::INTEGER)
+        {
+            return float(int_expr(ast, index));
+        }
+
+        float lval = calc_expr(ast, n.a);
+
+        return lval * calc_expr(ast, n.b);
+    }
+    case Node::DIVISION:
+    {
+        float rval = calc_expr(ast, n.b);
+        if (rval == 0.f)
+        {
+            throw ZeroDivisionError();
+        }
+        return calc_expr(ast, n.a) / rval;
+    }
+    case Node::VAR:
+    {
+        const Value& v = var(int(n.c), ast.name(n));
+
+        if (n.vartype == Type::INTEGER)
+        {
+            return v.ival;
+        }
+        else if (n.vartype == Type::FLOAT)
+        {
+            return v.fval;
+        }
+        else
+        {
+            throw InterpreterException("Not number variable");
+        }
+    }
+    default:
+        throw InterpreterException("Unknown exception");
+    }
+}
+
+int Interpreter::calc_int(const FlatAst& ast, uint32_t index)
+{
+    if (ast.at(index).vartype != Type::INTEGER)
     {
-        run(wcn->body.get());
+        return int(calc_expr(ast, index));
     }
-}
\ No newline at end of file
+
+    return int_expr(ast, index);
+}
+
+int Interpreter::int_expr(const FlatAst& ast, uint32_t index)
+{
+    const FlatNode& n = ast.at(index);
+
+    switch(n.tag)
+    {
+    case Node::INTEGER:
+        return FlatAst::int_value(n);
+    case Node::VAR:
+        return var(int(n.c), ast.name(n)).ival;
+    case Node::SUM:
+    {
+        int lval = int_expr(ast, n.a);
+
+        return int_add(lval, int_expr(ast, n.b));
+    }
+    case Node::SUBTRACT:
+    {
+        int lval = int_expr(ast, n.a);
+
+        return int_subtract(lval, int_expr(ast, n.b));
+    }
+    case Node::MULTIPLICATION:
+    {
+        int lval = int_expr(ast, n.a);
+
+        return int_multiply(lval, int_expr(ast, n.b));
+    }
+    default:
+        throw InterpreterException("Unknown exception: int_expr()");
+    }
+}
+
+// The comparison tag stands for, on operands already worked out
+template <class T>
+static bool compare(int tag, T left, T right)
+{
+    switch(tag)
+    {
+    case Node::EQUALS:
+        return left == right;
+    case Node::GREATER:
+        return left > right;
+    case Node::GOQ:
+        return left >= right;
+    case Node::LESSER:
+        return left < right;
+    default:
+        return left <= right;
+    }
+}
+
+bool Interpreter::calc_logic(const FlatAst& ast, uint32_t index)
+{
+    const FlatNode& n = ast.at(index);
+
+    // Both sides of a comparison are integers
+    bool ints = n.tag >= Node::EQUALS && n.tag <= Node::LOQ && ast.at(n.a).vartype == Type::INTEGER && ast.at(n.b).vartype == Type::INTEGER;
+
+    switch(n.tag)
+    {
+    case Node::AND:
+        return calc_logic(ast, n.a) && calc_logic(ast, n.b);
+    case Node::OR:
+        return calc_logic(ast, n.a) || calc_logic(ast, n.b);
+    case Node::EQUALS:
+    case Node::GREATER:
+    case Node::GOQ:
+    case Node::LESSER:
+    case Node::LOQ:
+        break;
+    default:
+        throw InterpreterException("Unknown exception: calc_logic()");
+    }
+
+    if (ints)
+    {
+        int lval = int_expr(ast, n.a);
+
+        return compare(n.tag, lval, int_expr(ast, n.b));
+    }
+
+    float lval = calc_expr(ast, n.a);
+
+    return compare(n.tag, lval, calc_expr(ast, n.b));
+}
@@ -1,34 +1,20 @@
 #include <Lexer.h>
+#include <Scanner.h>
+#include <Literals.h>
 
 #include <iostream>
 #include <cmath>
 #include <sstream>
+#include <type_traits>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <memory>
 
-Token::Token(const Token& other)
-{
-    this->type = other.type;
-
-    this->ival = other.ival;
-    this->fval = other.fval;
-    this->sval = other.sval;
-
-    this->line = other.line;
-    this->chr = other.chr;
-}
-
-Token Token::operator=(const Token& other)
-{
-    this->type = other.type;
-
-    this->ival = other.ival;
-    this->fval = other.fval;
-    this->sval = other.sval;
-
-    this->line = other.line;
-    this->chr = other.chr;
-
-    return other;
-}
+static_assert(std::is_trivially_copyable<Token>::value, "Token should stay a plain value");
 
 bool Token::is_same(const Token& other) const
 {
@@ -46,7 +32,7 @@ bool Token::is_same(const Token& other) const
         return fabs(this->fval - other.fval) < 0.001f;
         break;
     case Token::STRING:
-        return this->sval == other.sval;
+        return this->sym == other.sym;
         break;
     default:
         return true;
@@ -84,7 +70,7 @@ std::string Token::to_string() const
     case SLASH: return "/";
     case INTTYPE: return "int";
     case FLOATTYPE: return "float";
-    case STRING: return sval;
+    case STRING: return name();
     case PRINT: return "print";
     case IF: return "if";
     case ELSE: return "else";
@@ -95,16 +81,51 @@ std::string Token::to_string() const
     }
 }
 
-Lexer::Lexer() : position(0), line(0), chr(0)
+static_assert(Lexer::keyword_type("int", 3) == Token::INTTYPE, "keyword table is broken");
+static_assert(Lexer::keyword_type("float", 5) == Token::FLOATTYPE, "keyword table is broken");
+static_assert(Lexer::keyword_type("print", 5) == Token::PRINT, "keyword table is broken");
+static_assert(Lexer::keyword_type("if", 2) == Token::IF, "keyword table is broken");
+static_assert(Lexer::keyword_type("else", 4) == Token::ELSE, "keyword table is broken");
+static_assert(Lexer::keyword_type("for", 3) == Token::FOR, "keyword table is broken");
+static_assert(Lexer::keyword_type("while", 5) == Token::WHILE, "keyword table is broken");
+static_assert(Lexer::keyword_type("fort", 4) == Token::STRING, "keyword table is broken");
+static_assert(Lexer::keyword_type("whilst", 6) == Token::STRING, "keyword table is broken");
+
+void TokenBuffer::reserve(size_t n)
 {
-    keywords["int"] = Token::INTTYPE;
-    keywords["float"] = Token::FLOATTYPE;
-    keywords["print"] = Token::PRINT;
-    keywords["if"] = Token::IF;
-    keywords["else"] = Token::ELSE;
-    keywords["for"] = Token::FOR;
-    keywords["while"] = Token::WHILE;
+    types.reserve(n);
+    offsets.reserve(n);
+    values.reserve(n);
+}
+
+void TokenBuffer::resize(size_t n)
+{
+    types.resize(n);
+    offsets.resize(n);
+    values.resize(n);
+}
 
+void TokenBuffer::clear()
+{
+    types.clear();
+    offsets.clear();
+    values.clear();
+}
+
+bool VectorTokenSource::next_token(Token& out)
+{
+    if (position >= tokens.size())
+    {
+        return false;
+    }
+
+    out = tokens[position++];
+
+    return true;
+}
+
+Lexer::Lexer() : code(""), length(0), position(0), input(0), base(0), symbols(&SymbolTable::global())
+{
     reload();
 }
 
@@ -114,87 +135,354 @@ Lexer::~Lexer()
 }
 
 std::vector<Token> Lexer::make_tokens(const std::string& code)
+{
+    return make_tokens(code.data(), code.length());
+}
+
+std::vector<Token> Lexer::make_tokens(const SourceFile& file)
+{
+    return make_tokens(file.data(), file.size());
+}
+
+std::vector<Token> Lexer::make_tokens(const char* code, size_t length)
 {
     std::vector<Token> out = {};
 
-    while(position < code.length())
+    begin(code, length);
+
+    Token t;
+
+    while(next_token(t))
+    {
+        out.push_back(t);
+    }
+
+    return out;
+}
+
+void Lexer::make_tokens(const char* code, size_t length, TokenBuffer& out)
+{
+    begin(code, length);
+
+    Token t;
+
+    while(next_token(t))
+    {
+        out.push_back(t);
+    }
+}
+
+// Runs job(0) ... job(count - 1) on up to threads threads
+template <class Job>
+static void parallel_for(size_t count, unsigned threads, const Job& job)
+{
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            try
+            {
+                job(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+
+    for (unsigned i = 1; i < threads && i < count; i++)
+    {
+        pool.push_back(std::thread(worker));
+    }
+
+    worker();
+
+    for (size_t i = 0; i < pool.size(); i++)
+    {
+        pool[i].join();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void Lexer::make_tokens_parallel(const char* code, size_t length, TokenBuffer& out, unsigned threads)
+{
+    static const size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    size_t chunk_count = std::min(size_t(threads) * 4, length / MIN_CHUNK_SIZE);
+
+    if (threads == 1 || chunk_count <= 1)
+    {
+        out.clear();
+        make_tokens(code, length, out);
+        return;
+    }
+
+    // No token contains whitespace, so cutting there never splits one
+    std::vector<size_t> bounds(1, 0);
+
+    for (size_t i = 1; i < chunk_count; i++)
     {
+        size_t bound = std::max(length / chunk_count * i, bounds.back());
 
-        while(is_empty(code[position]) && position < code.length())
+        while (bound < length && !is_empty(code[bound]))
         {
-            advance(code);
+            bound++;
         }
 
-        if(position >= code.length())
+        if (bound > bounds.back() && bound < length)
         {
-            return out;
+            bounds.push_back(bound);
         }
+    }
+
+    bounds.push_back(length);
+    chunk_count = bounds.size() - 1;
+
+    struct Chunk
+    {
+        TokenBuffer tokens;
+        SymbolTable symbols;
+        std::vector<int> global_ids;
+    };
+
+    std::vector<std::unique_ptr<Chunk>> chunks(chunk_count);
+
+    try
+    {
+        parallel_for(chunk_count, threads, [&](size_t i)
+        {
+            chunks[i].reset(new Chunk);
 
-        out.push_back(get_token(code));
+            Lexer l;
+            l.symbols = &chunks[i]->symbols;
+            l.make_tokens(code + bounds[i], bounds[i + 1] - bounds[i], chunks[i]->tokens);
+        });
+    }
+    catch (const LexerException&)
+    {
+        // The error only knows its place inside the piece, so lex the whole
+        // input again to get it reported at the right line
+        out.clear();
+        make_tokens(code, length, out);
+        return;
     }
 
+    // Place of every chunk in the output, and the global ids of its names
+    std::vector<size_t> starts(chunk_count + 1, 0);
+
+    for (size_t i = 0; i < chunk_count; i++)
+    {
+        starts[i + 1] = starts[i] + chunks[i]->tokens.size();
+
+        SymbolTable& symbols = chunks[i]->symbols;
+
+        for (size_t id = 0; id < symbols.size(); id++)
+        {
+            chunks[i]->global_ids.push_back(SymbolTable::global().intern(symbols.name(int(id))));
+        }
+    }
+
+    out.resize(starts.back());
+
+    parallel_for(chunk_count, threads, [&](size_t i)
+    {
+        const Chunk& chunk = *chunks[i];
+
+        for (size_t j = 0; j < chunk.tokens.size(); j++)
+        {
+            Token t = chunk.tokens.at(j);
+
+            t.offset += bounds[i];
+
+            if (t.type == Token::STRING)
+            {
+                t.sym = chunk.global_ids[t.sym];
+            }
+
+            out.set(starts[i] + j, t);
+        }
+    });
+
+    lines.reset(code, length);
+}
+
+void Lexer::begin(const char* code, size_t length)
+{
     reload();
 
-    return out;
+    this->code = code;
+    this->length = length;
+
+    lines.reset(code, length);
 }
 
-Token Lexer::make_number(const std::string& code)
+void Lexer::begin(std::istream& input)
 {
-    std::string s;
+    reload();
 
-    int point_count = 0;
+    this->input = &input;
+
+    lines.reset_stream();
+}
 
-    while(position < code.length() && (is_digit(code[position]) || code[position] == '.'))
+bool Lexer::next_token(Token& out)
+{
+    while(true)
     {
-        if(code[position] == '.')
+        advance_to(scan_whitespace(code + position, code + length) - code);
+
+        if(position >= length)
         {
-            point_count++;
-            if(point_count > 1)
+            if(refill(position))
             {
-                break;
+                continue;
             }
+
+            reload();
+
+            return false;
         }
 
-        s.push_back(code[position]);
-        advance(code);
-    }
+        size_t start = position;
 
-    if(point_count >= 1)
-    {
-        return Token(std::stof(s), line, chr);
+        try
+        {
+            out = get_token();
+        }
+        catch (const LexerException&)
+        {
+            // Only the start of a token may have been read, as with a '.'
+            // whose digits are in the next chunk
+            if(position >= length && refill(start))
+            {
+                position = 0;
+                continue;
+            }
+
+            throw;
+        }
+
+        // A token that runs up to the end of the buffer may continue in the
+        // part of the stream that hasn't been read yet
+        if(position >= length && refill(start))
+        {
+            position = 0;
+            continue;
+        }
+
+        out.offset += base;
+
+        return true;
     }
-    else
+}
+
+bool Lexer::refill(size_t keep_from)
+{
+    static const size_t CHUNK_SIZE = 64 * 1024;
+
+    if(!input || !*input)
     {
-        return IntegerToken(std::stoi(s), line, chr);
+        return false;
     }
+
+    buffer.erase(buffer.begin(), buffer.begin() + keep_from);
+    base += keep_from;
+    position -= keep_from;
+
+    size_t old_size = buffer.size();
+
+    buffer.resize(old_size + CHUNK_SIZE);
+    input->read(buffer.data() + old_size, CHUNK_SIZE);
+    buffer.resize(old_size + size_t(input->gcount()));
+
+    lines.feed(buffer.data() + old_size, buffer.size() - old_size);
+
+    code = buffer.data();
+    length = buffer.size();
+
+    return buffer.size() > old_size;
 }
 
-void Lexer::advance(const std::string& code)
+Token Lexer::make_number()
 {
-    position++;
+    size_t start = position;
+    size_t end = scan_digits(code + position, code + length) - code;
 
-    if(code[position] == '\n')
+    bool is_float = end < length && code[end] == '.';
+
+    if(is_float)
     {
-        line++;
-        chr = 0;
+        end = scan_digits(code + end + 1, code + length) - code;
     }
-    else
+
+    Token t(is_float ? Token::FLOAT : Token::INTEGER, start);
+
+    LiteralStatus status = is_float ? parse_float_literal(code + start, code + end, t.fval) : parse_int_literal(code + start, code + end, t.ival);
+
+    // Past the literal even when it is broken, so that next_token() can
+    // tell whether it runs up to the end of the buffer
+    advance_to(end);
+
+    if (status == LITERAL_OVERFLOW)
     {
-        chr++;
+        throw NumberOverflowError(std::string(code + start, end - start), lines.locate(start + base));
     }
+
+    if (status == LITERAL_INVALID)
+    {
+        throw InvalidNumberError(std::string(code + start, end - start), lines.locate(start + base));
+    }
+
+    return t;
+}
+
+void Lexer::advance()
+{
+    position++;
+}
+
+void Lexer::advance_to(size_t new_position)
+{
+    position = new_position;
 }
 
 void Lexer::reload()
 {
+    code = "";
+    length = 0;
     position = 0;
-    line = 0;
-    chr = 0;
+
+    input = 0;
+    buffer.clear();
+    base = 0;
 }
 
-Token Lexer::get_token(const std::string& code)
+Token Lexer::get_token()
 {
+    size_t start = position;
     int type = -1;
-    switch(code[position])
+    switch(cur_char())
     {
     case '{':
         type = Token::LBRACE;
@@ -227,64 +515,64 @@ Token Lexer::get_token(const std::string& code)
         type = Token::MINUS;
         break;
     case '=':
-        advance(code);
+        advance();
 
-        if(code[position] == '=')
+        if(cur_char() == '=')
         {
-            advance(code);
+            advance();
 
-            return Token(Token::EQEQ, line, chr);
+            return Token(Token::EQEQ, start);
         }
 
-        return Token(Token::EQUAL, line, chr);
+        return Token(Token::EQUAL, start);
         break;
     case '>':
-        advance(code);
+        advance();
 
-        if(code[position] == '=')
+        if(cur_char() == '=')
         {
-            advance(code);
+            advance();
 
-            return Token(Token::GOQ, line, chr);
+            return Token(Token::GOQ, start);
         }
 
-        return Token(Token::GREATER, line, chr);
+        return Token(Token::GREATER, start);
         break;
     case '<':
-        advance(code);
+        advance();
 
-        if(code[position] == '=')
+        if(cur_char() == '=')
         {
-            advance(code);
+            advance();
 
-            return Token(Token::LOQ, line, chr);
+            return Token(Token::LOQ, start);
         }
 
-        return Token(Token::LESSER, line, chr);
+        return Token(Token::LESSER, start);
         break;
     case '&':
-        advance(code);
+        advance();
 
-        if(code[position] == '&')
+        if(cur_char() == '&')
         {
-            advance(code);
+            advance();
 
-            return Token(Token::ANDAND, line, chr);
+            return Token(Token::ANDAND, start);
         }
 
-        return Token(Token::AND, line, chr);
+        return Token(Token::AND, start);
         break;
     case '|':
-        advance(code);
+        advance();
 
-        if(code[position] == '|')
+        if(cur_char() == '|')
         {
-            advance(code);
+            advance();
 
-            return Token(Token::OROR, line, chr);
+            return Token(Token::OROR, start);
         }
 
-        return Token(Token::OR, line, chr);
+        return Token(Token::OR, start);
         break;
     case '*':
         type = Token::ASTERISK;
@@ -296,40 +584,38 @@ Token Lexer::get_token(const std::string& code)
 
     if(type != -1)
     {
-        advance(code);
-        return Token(type, line, chr);
+        advance();
+        return Token(type, start);
     }
 
-    if(is_digit(code[position]) || code[position] == '.')
+    if(is_digit(cur_char()) || cur_char() == '.')
     {
-        return make_number(code);
+        return make_number();
     }
 
-    std::string word = get_word(code);
-    
-    try
-    {
-        int code = keywords.at(word);
+    size_t word_length = get_word();
 
-        return Token(code);
-    }
-    catch(const std::exception& e)
+    type = keyword_type(code + start, word_length);
+
+    if (type != Token::STRING)
     {
-        return Token(word);
+        return Token(type, start);
     }
+
+    Token t(Token::STRING, start);
+
+    t.sym = symbols->intern(code + start, word_length);
+
+    return t;
 }
 
-std::string Lexer::get_word(const std::string& code)
+size_t Lexer::get_word()
 {
-    std::string out;
+    size_t start = position;
 
-    while(!is_empty(code[position]) && is_valid_for_naming(code[position]) && position < code.length())
-    {
-        out.push_back(code[position]);
-        advance(code);
-    }
+    advance_to(scan_identifier(code + position, code + length) - code);
 
-    return out;
+    return position - start;
 }
 
 bool Lexer::is_number(const std::string& s)
@@ -341,4 +627,73 @@ bool Lexer::is_number(const std::string& s)
     }
 
     return true;
+}
+
+void LineIndex::reset(const char* code, size_t length)
+{
+    this->code = code;
+    this->length = length;
+
+    built = false;
+    newlines.clear();
+}
+
+void LineIndex::reset_stream()
+{
+    code = "";
+    length = 0;
+
+    built = true;
+    newlines.clear();
+}
+
+void LineIndex::feed(const char* chunk, size_t chunk_length)
+{
+    const char* end = chunk + chunk_length;
+
+    for (const char* p = chunk; (p = (const char*)memchr(p, '\n', end - p)) != 0; p++)
+    {
+        newlines.push_back(length + (p - chunk));
+    }
+
+    length += chunk_length;
+}
+
+SourcePosition LineIndex::locate(size_t offset)
+{
+    if (!built)
+    {
+        build();
+    }
+
+    // Number of line breaks before offset
+    size_t line = std::lower_bound(newlines.begin(), newlines.end(), offset) - newlines.begin();
+
+    size_t line_start = line == 0 ? 0 : newlines[line - 1] + 1;
+
+    return SourcePosition(offset, int(line) + 1, int(offset - line_start) + 1);
+}
+
+void LineIndex::build()
+{
+    const char* end = code + length;
+
+    newlines.reserve(count_char(code, end, '\n'));
+
+    for (const char* p = code; (p = (const char*)memchr(p, '\n', end - p)) != 0; p++)
+    {
+        newlines.push_back(p - code);
+    }
+
+    built = true;
+}
+
+std::string SourcePosition::to_string() const
+{
+    if (line == 0)
+    {
+        return std::to_string(offset) + " offset";
+    }
+
+    return std::to_string(line) + " line, " + std::to_string(column) + " column";
 }
\ No newline at end of file
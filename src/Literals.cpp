@@ -0,0 +1,440 @@
+#include <Literals.h>
+
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+LiteralStatus parse_int_literal(const char* begin, const char* end, int& out)
+{
+    if (begin == end)
+    {
+        return LITERAL_INVALID;
+    }
+
+    unsigned value = 0;
+
+    for (const char* p = begin; p < end; p++)
+    {
+        unsigned digit = unsigned(*p - '0');
+
+        if (digit > 9)
+        {
+            return LITERAL_INVALID;
+        }
+
+        if (value > (unsigned(INT_MAX) - digit) / 10)
+        {
+            return LITERAL_OVERFLOW;
+        }
+
+        value = value * 10 + digit;
+    }
+
+    out = int(value);
+
+    return LITERAL_OK;
+}
+
+// Digits of a literal with the decimal point and leading zeros taken out:
+// value = mantissa * 10^exponent, plus something below the last kept digit
+// if truncated is set.
+struct DecimalDigits
+{
+    uint64_t mantissa;
+    int exponent;
+    int count;
+    bool truncated;
+};
+
+static LiteralStatus read_digits(const char* begin, const char* end, DecimalDigits& out)
+{
+    static const int MAX_DIGITS = 19; // always fits into uint64_t
+
+    out.mantissa = 0;
+    out.exponent = 0;
+    out.count = 0;
+    out.truncated = false;
+
+    bool seen_point = false;
+    bool seen_digit = false;
+
+    for (const char* p = begin; p < end; p++)
+    {
+        if (*p == '.')
+        {
+            if (seen_point)
+            {
+                return LITERAL_INVALID;
+            }
+
+            seen_point = true;
+            continue;
+        }
+
+        unsigned digit = unsigned(*p - '0');
+
+        if (digit > 9)
+        {
+            return LITERAL_INVALID;
+        }
+
+        seen_digit = true;
+
+        if (out.count == 0 && digit == 0) // leading zero
+        {
+            out.exponent -= seen_point;
+        }
+        else if (out.count < MAX_DIGITS)
+        {
+            out.mantissa = out.mantissa * 10 + digit;
+            out.count++;
+            out.exponent -= seen_point;
+        }
+        else
+        {
+            out.exponent += !seen_point;
+            out.truncated |= digit != 0;
+        }
+    }
+
+    return seen_digit ? LITERAL_OK : LITERAL_INVALID;
+}
+
+// Just enough of an unsigned big integer to compare a decimal literal with
+// a float rounding boundary exactly
+class BigInt
+{
+public:
+    BigInt(uint64_t value) : size(0)
+    {
+        while (value)
+        {
+            limbs[size++] = uint32_t(value);
+            value >>= 32;
+        }
+    }
+
+    void mul_add(uint32_t factor, uint32_t addend)
+    {
+        uint64_t carry = addend;
+
+        for (int i = 0; i < size; i++)
+        {
+            uint64_t v = uint64_t(limbs[i]) * factor + carry;
+            limbs[i] = uint32_t(v);
+            carry = v >> 32;
+        }
+
+        if (carry && size < LIMB_COUNT)
+        {
+            limbs[size++] = uint32_t(carry);
+        }
+    }
+
+    void mul_pow10(int n)
+    {
+        static const uint32_t pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+        for (; n >= 9; n -= 9)
+        {
+            mul_add(pow10[9], 0);
+        }
+
+        mul_add(pow10[n], 0);
+    }
+
+    void shift_left(int bits)
+    {
+        int limb_shift = bits / 32;
+        int bit_shift = bits % 32;
+
+        if (size == 0)
+        {
+            return;
+        }
+
+        int new_size = size + limb_shift + 1;
+
+        if (new_size > LIMB_COUNT)
+        {
+            new_size = LIMB_COUNT;
+        }
+
+        for (int i = new_size - 1; i >= 0; i--)
+        {
+            int from = i - limb_shift;
+
+            uint64_t hi = from >= 0 && from < size ? limbs[from] : 0;
+            uint64_t lo = from - 1 >= 0 && from - 1 < size ? limbs[from - 1] : 0;
+
+            limbs[i] = uint32_t(((hi << 32 | lo) << bit_shift) >> 32);
+        }
+
+        size = new_size;
+
+        while (size > 0 && limbs[size - 1] == 0)
+        {
+            size--;
+        }
+    }
+
+    int compare(const BigInt& other) const
+    {
+        if (size != other.size)
+        {
+            return size < other.size ? -1 : 1;
+        }
+
+        for (int i = size - 1; i >= 0; i--)
+        {
+            if (limbs[i] != other.limbs[i])
+            {
+                return limbs[i] < other.limbs[i] ? -1 : 1;
+            }
+        }
+
+        return 0;
+    }
+private:
+    // 4096 bits: enough for 780 digits scaled by 10^860 or 2^150
+    static const int LIMB_COUNT = 128;
+
+    uint32_t limbs[LIMB_COUNT];
+    int size;
+};
+
+// All significant digits of a literal, as many as can take part in
+// deciding how it rounds
+struct ExactDecimal
+{
+    ExactDecimal() : digits(0), exponent(0), truncated(false) {}
+
+    BigInt digits;
+    int exponent;
+    bool truncated;
+};
+
+static void read_exact(const char* begin, const char* end, ExactDecimal& out)
+{
+    // A float rounding boundary has fewer than 120 significant digits, so
+    // anything past this only matters as "a little more"
+    static const int MAX_DIGITS = 780;
+
+    bool seen_point = false;
+    int count = 0;
+
+    uint32_t chunk = 0;
+    uint32_t chunk_scale = 1;
+
+    for (const char* p = begin; p < end; p++)
+    {
+        if (*p == '.')
+        {
+            seen_point = true;
+            continue;
+        }
+
+        unsigned digit = unsigned(*p - '0');
+
+        if (count == 0 && digit == 0)
+        {
+            out.exponent -= seen_point;
+        }
+        else if (count < MAX_DIGITS)
+        {
+            chunk = chunk * 10 + digit;
+            chunk_scale *= 10;
+            count++;
+            out.exponent -= seen_point;
+
+            if (chunk_scale == 1000000000)
+            {
+                out.digits.mul_add(chunk_scale, chunk);
+                chunk = 0;
+                chunk_scale = 1;
+            }
+        }
+        else
+        {
+            out.exponent += !seen_point;
+            out.truncated |= digit != 0;
+        }
+    }
+
+    out.digits.mul_add(chunk_scale, chunk);
+}
+
+// Sign of (value - boundary), where boundary is halfway between f and the
+// next float up
+static int compare_with_midpoint(const ExactDecimal& value, float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+
+    uint32_t biased_exponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    int exponent = -149;
+
+    if (biased_exponent != 0)
+    {
+        mantissa |= 0x800000;
+        exponent = int(biased_exponent) - 150;
+    }
+
+    // value.digits * 10^value.exponent <=> (2 * mantissa + 1) * 2^(exponent - 1)
+    BigInt lhs = value.digits;
+    BigInt rhs(2 * uint64_t(mantissa) + 1);
+
+    if (value.exponent >= 0)
+    {
+        lhs.mul_pow10(value.exponent);
+    }
+    else
+    {
+        rhs.mul_pow10(-value.exponent);
+    }
+
+    if (exponent - 1 >= 0)
+    {
+        rhs.shift_left(exponent - 1);
+    }
+    else
+    {
+        lhs.shift_left(1 - exponent);
+    }
+
+    int result = lhs.compare(rhs);
+
+    return result == 0 && value.truncated ? 1 : result;
+}
+
+static bool is_odd(float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+
+    return bits & 1;
+}
+
+static LiteralStatus round_exactly(const char* begin, const char* end, double approximation, float& out)
+{
+    ExactDecimal value;
+    read_exact(begin, end, value);
+
+    // approximation is off by a few double ulps at most, so this is at
+    // most one float away from the answer
+    float f = approximation >= FLT_MAX ? FLT_MAX : float(approximation);
+
+    while (true)
+    {
+        int above = compare_with_midpoint(value, f);
+
+        if (above > 0 || (above == 0 && is_odd(f)))
+        {
+            if (f == FLT_MAX)
+            {
+                return LITERAL_OVERFLOW;
+            }
+
+            f = std::nextafter(f, HUGE_VALF);
+            continue;
+        }
+
+        if (f > 0.f)
+        {
+            float down = std::nextafter(f, 0.f);
+            int below = compare_with_midpoint(value, down);
+
+            if (below < 0 || (below == 0 && !is_odd(down)))
+            {
+                f = down;
+                continue;
+            }
+        }
+
+        break;
+    }
+
+    out = f;
+
+    return LITERAL_OK;
+}
+
+// true when d lies exactly halfway between two floats, which is the only
+// case where rounding a correctly rounded double to float can go wrong
+static bool is_float_midpoint(double d)
+{
+    float f = float(d);
+
+    if (double(f) == d)
+    {
+        return false;
+    }
+
+    if (std::isinf(f))
+    {
+        return d == double(FLT_MAX) + std::ldexp(1.0, 103);
+    }
+
+    double other = d > f ? double(std::nextafter(f, HUGE_VALF)) : double(std::nextafter(f, -HUGE_VALF));
+
+    if (std::isinf(other))
+    {
+        other = std::ldexp(1.0, 128);
+    }
+
+    return (double(f) + other) / 2 == d;
+}
+
+LiteralStatus parse_float_literal(const char* begin, const char* end, float& out)
+{
+    static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    DecimalDigits digits;
+    LiteralStatus status = read_digits(begin, end, digits);
+
+    if (status != LITERAL_OK)
+    {
+        return status;
+    }
+
+    if (digits.mantissa == 0)
+    {
+        out = 0.f;
+        return LITERAL_OK;
+    }
+
+    int magnitude = digits.count + digits.exponent; // value < 10^magnitude
+
+    if (magnitude > 39) // >= 10^39
+    {
+        return LITERAL_OVERFLOW;
+    }
+
+    if (magnitude < -45) // below half of the smallest float
+    {
+        out = 0.f;
+        return LITERAL_OK;
+    }
+
+    // Both the mantissa and the power of ten are exact doubles, so the
+    // product or quotient is the correctly rounded double of the literal
+    if (!digits.truncated && digits.mantissa <= (uint64_t(1) << 53) && digits.exponent >= -22 && digits.exponent <= 22)
+    {
+        double value = digits.exponent >= 0 ? double(digits.mantissa) * pow10[digits.exponent] : double(digits.mantissa) / pow10[-digits.exponent];
+
+        bool exact = digits.exponent >= 0 && value <= double(uint64_t(1) << 53);
+
+        if (exact || !is_float_midpoint(value))
+        {
+            out = float(value);
+
+            return std::isinf(out) ? LITERAL_OVERFLOW : LITERAL_OK;
+        }
+    }
+
+    return round_exactly(begin, end, double(digits.mantissa) * std::pow(10.0, digits.exponent), out);
+}
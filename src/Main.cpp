@@ -1,43 +1,103 @@
 #include <Interpreter.h>
-#include <fstream>
-#include <sstream>
+#include <SourceFile.h>
+#include <Optimizer.h>
 
 int main(int argc, char** argv)
 {
     Lexer l;
 
-    while (1)
-    {
-        try
-        {
-            std::string input;
-
-            std::fstream file("C:\\Users\\user123\\Desktop\\MS.txt");
-            std::stringstream ss; 
-            ss << file.rdbuf();
+    std::string path = "C:\\Users\\user123\\Desktop\\MS.txt";
 
-            input = ss.str();
+    // interpreter_v_0_0_1 [--engine=tree|bytecode|closures] [path or - for stdin]
+    Interpreter::Engine engine = Interpreter::TREE_WALKER;
 
-            std::vector<Token> tokens = l.make_tokens(input);
-
-            Parser p(tokens);
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
 
-            std::shared_ptr<SequenceNode> sn = p.make_tree();
+        if (arg == "--engine=tree")
+        {
+            engine = Interpreter::TREE_WALKER;
+        }
+        else if (arg == "--engine=bytecode")
+        {
+            engine = Interpreter::BYTECODE;
+        }
+        else if (arg == "--engine=closures")
+        {
+            engine = Interpreter::CLOSURES;
+        }
+        else if (arg.compare(0, 9, "--engine=") == 0)
+        {
+            std::cout << "Unknown engine " << arg.substr(9) << ", use tree, bytecode or closures" << std::endl;
 
-            Interpreter i;
+            return 1;
+        }
+        else
+        {
+            path = arg;
+        }
+    }
 
-            i.run(sn.get());
+    try
+    {
+        SourceFile file;
 
-            break;
+        if (path == "-")
+        {
+            l.begin(std::cin);
         }
-        catch (const ParserException& e)
+        else
         {
-            std::cout << "A Parser exception occured! - " << e.what() << std::endl;
+            file.open(path);
+            l.begin(file);
         }
-        catch (const InterpreterException& e)
+
+        Parser p(l, &l.line_index());
+
+        SequenceNode* sn = p.make_sequence();
+
+        const std::vector<std::shared_ptr<ParserException>>& diagnostics = p.get_diagnostics();
+
+        if (!diagnostics.empty())
         {
-            std::cout << "A Interpreter exception occured! - " << e.what() << std::endl;
+            for (size_t i = 0; i < diagnostics.size(); i++)
+            {
+                std::cout << "A Parser exception occured! - " << diagnostics[i]->what() << std::endl;
+            }
+
+            return 1;
         }
+
+        Node* program = Optimizer(*p.get_arena()).optimize(sn);
+
+        Interpreter i(engine);
+
+        i.run(program);
+    }
+    catch (const LexerException& e)
+    {
+        std::cout << "A Lexer exception occured! - " << e.what() << std::endl;
+
+        return 1;
+    }
+    catch (const ParserException& e)
+    {
+        std::cout << "A Parser exception occured! - " << e.what() << std::endl;
+
+        return 1;
+    }
+    catch (const InterpreterException& e)
+    {
+        std::cout << "A Interpreter exception occured! - " << e.what() << std::endl;
+
+        return 1;
+    }
+    catch (const SourceFileException& e)
+    {
+        std::cout << "A Source file exception occured! - " << e.what() << std::endl;
+
+        return 1;
     }
 
     return 0;
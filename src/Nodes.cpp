@@ -15,7 +15,7 @@ bool SequenceNode::is_same(const Node* other) {
 
     for (int i = 0; i < nodes.size(); i++)
     {
-        if (!this->nodes[i]->is_same(ot->nodes[i].get()))
+        if (!this->nodes[i]->is_same(ot->nodes[i]))
         {
             return false;
         }
@@ -62,9 +62,9 @@ bool DeclareVariableNode::is_same(const Node* other)
         return false;
     }
     
-    if(!this->expression.get() || !ot->expression.get())
+    if(!this->expression || !ot->expression)
     {
-        if (this->expression.get() || ot->expression.get())
+        if (this->expression || ot->expression)
         {
             return false;
         }
@@ -72,7 +72,7 @@ bool DeclareVariableNode::is_same(const Node* other)
         return true;
     }
     
-    return this->expression->is_same(ot->expression.get());
+    return this->expression->is_same(ot->expression);
 }
 
 std::string DeclareVariableNode::to_string()
@@ -97,7 +97,7 @@ std::string DeclareVariableNode::to_string()
 
     out += std::string(" ") + name;
 
-    if (!expression.get())
+    if (!expression)
     {
         return out;
     }
@@ -165,17 +165,17 @@ bool BinaryNode::is_same(const Node* other)
 
     BinaryNode* ot = (BinaryNode*)other;
 
-    if (!this->left.get())
+    if (!this->left)
     {
-        return !ot->left.get();
+        return !ot->left;
     }
 
-    if (!this->right.get())
+    if (!this->right)
     {
-        return !ot->right.get();
+        return !ot->right;
     }
 
-    return this->left->is_same(ot->left.get()) && this->right->is_same(ot->right.get());
+    return this->left->is_same(ot->left) && this->right->is_same(ot->right);
 }
 
 std::string BinaryNode::to_string()
@@ -183,6 +183,28 @@ std::string BinaryNode::to_string()
     return std::string("(") + left->to_string() + std::string(" ") + op + std::string(" ") + right->to_string() + std::string(")");
 }
 
+int BinaryNode::value_type(int type, const Node* left, const Node* right)
+{
+    switch (type)
+    {
+    case SUM:
+    case SUBTRACT:
+    case MULTIPLICATION:
+        if (left && right && left->valtype == Type::INTEGER && right->valtype == Type::INTEGER)
+        {
+            return Type::INTEGER;
+        }
+
+        return Type::FLOAT;
+    case DIVISION:
+        return Type::FLOAT;
+    case ASSIGN:
+        return Type::VOID;
+    default: // comparisons, && and ||
+        return Type::BOOL;
+    }
+}
+
 bool SumNode::is_same(const Node* other)
 {
     if (!Node::is_same(other))
@@ -192,17 +214,17 @@ bool SumNode::is_same(const Node* other)
 
     SumNode* ot = (SumNode*)other;
 
-    if (!this->left.get())
+    if (!this->left)
     {
-        return !ot->left.get();
+        return !ot->left;
     }
 
-    if (!this->right.get())
+    if (!this->right)
     {
-        return !ot->right.get();
+        return !ot->right;
     }
 
-    return (this->left->is_same(ot->left.get()) && this->right->is_same(ot->right.get())) || (this->left->is_same(ot->right.get()) && this->right->is_same(ot->left.get()));
+    return (this->left->is_same(ot->left) && this->right->is_same(ot->right)) || (this->left->is_same(ot->right) && this->right->is_same(ot->left));
 }
 
 bool MultiplicationNode::is_same(const Node* other)
@@ -214,17 +236,17 @@ bool MultiplicationNode::is_same(const Node* other)
 
     MultiplicationNode* ot = (MultiplicationNode*)other;
 
-    if (!this->left.get())
+    if (!this->left)
     {
-        return !ot->left.get();
+        return !ot->left;
     }
 
-    if (!this->right.get())
+    if (!this->right)
     {
-        return !ot->right.get();
+        return !ot->right;
     }
 
-    return (this->left->is_same(ot->left.get()) && this->right->is_same(ot->right.get())) || (this->left->is_same(ot->right.get()) && this->right->is_same(ot->left.get()));
+    return (this->left->is_same(ot->left) && this->right->is_same(ot->right)) || (this->left->is_same(ot->right) && this->right->is_same(ot->left));
 }
 
 bool PrintNode::is_same(const Node* other)
@@ -243,7 +265,7 @@ bool PrintNode::is_same(const Node* other)
 
     for (int i = 0; i < this->expressions.size(); i++)
     {
-        if(!this->expressions[i]->is_same(ot->expressions[i].get()))
+        if(!this->expressions[i]->is_same(ot->expressions[i]))
         {
             return false;
         }
@@ -285,24 +307,24 @@ bool BranchingNode::is_same(const Node* other)
 
     BranchingNode* bn = (BranchingNode*)other;
 
-    if (!this->statement->is_same(bn->statement.get()))
+    if (!this->statement->is_same(bn->statement))
     {
         return false;
     }
 
-    if (!this->if_body->is_same(bn->if_body.get()))
+    if (!this->if_body->is_same(bn->if_body))
     {
         return false;
     }
 
-    if (!this->else_body.get() && !bn->else_body.get())
+    if (!this->else_body && !bn->else_body)
     {
         return true;
     }
 
-    if (this->else_body.get() && bn->else_body.get())
+    if (this->else_body && bn->else_body)
     {
-        return this->else_body->is_same(bn->else_body.get());
+        return this->else_body->is_same(bn->else_body);
     }
 
     return false;
@@ -314,7 +336,7 @@ std::string BranchingNode::to_string()
 
     out += statement->to_string() + std::string(")\n{\n") + if_body->to_string() + std::string("\n}");
 
-    if (!else_body.get())
+    if (!else_body)
     {
         return out;
     }
@@ -331,22 +353,22 @@ bool ForCycleNode::is_same(const Node* other)
 
     ForCycleNode* fcn = (ForCycleNode*)other;
 
-    if (!this->init->is_same(fcn->init.get()))
+    if (!this->init->is_same(fcn->init))
     {
         return false;
     }
 
-    if (!this->condition->is_same(fcn->condition.get()))
+    if (!this->condition->is_same(fcn->condition))
     {
         return false;
     }
 
-    if (!this->step->is_same(fcn->step.get()))
+    if (!this->step->is_same(fcn->step))
     {
         return false;
     }
 
-    if (!this->body->is_same(fcn->body.get()))
+    if (!this->body->is_same(fcn->body))
     {
         return false;
     }
@@ -373,12 +395,12 @@ bool WhileCycleNode::is_same(const Node* other)
 
     WhileCycleNode* wn = (WhileCycleNode*)other;
 
-    if (!this->condition->is_same(wn->condition.get()))
+    if (!this->condition->is_same(wn->condition))
     {
         return false;
     }
 
-    if (!this->body->is_same(wn->body.get()))
+    if (!this->body->is_same(wn->body))
     {
         return false;
     }
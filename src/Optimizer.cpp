@@ -0,0 +1,580 @@
+#include <Optimizer.h>
+
+#include <cmath>
+
+static bool is_constant(const Node* node)
+{
+    return node->type == Node::INTEGER || node->type == Node::FLOAT;
+}
+
+// A constant as calc_expr() gives it
+static float float_value(const Node* node)
+{
+    if (node->type == Node::INTEGER)
+    {
+        return float(static_cast<const IntNumNode*>(node)->val);
+    }
+
+    return static_cast<const FloatNumNode*>(node)->val;
+}
+
+// Sets reciprocal to 1 / divisor when x * reciprocal gives exactly x /
+// divisor for every x, which holds for powers of two
+static bool exact_reciprocal(float divisor, float& reciprocal)
+{
+    int exponent;
+
+    if (divisor == 0.f || std::isinf(divisor) || std::isnan(divisor) || std::fabs(std::frexp(divisor, &exponent)) != 0.5f)
+    {
+        return false;
+    }
+
+    reciprocal = 1.f / divisor;
+
+    return !std::isinf(reciprocal) && reciprocal * divisor == 1.f;
+}
+
+Optimizer::Optimizer(AstArena& arena) : arena(arena), changed(0)
+{
+
+}
+
+Node* Optimizer::optimize(Node* node)
+{
+    declared.clear();
+
+    return block(node);
+}
+
+static bool is_empty(const Node* node)
+{
+    return node->type == Node::SEQUENCE && static_cast<const SequenceNode*>(node)->nodes.empty();
+}
+
+Node* Optimizer::block(Node* node)
+{
+    Node* result = statement(node);
+
+    return result ? result : arena.make<SequenceNode>();
+}
+
+Node* Optimizer::statement(Node* node)
+{
+    if (!node)
+    {
+        return node;
+    }
+
+    switch (node->type)
+    {
+    case Node::SEQUENCE:
+    {
+        SequenceNode* sn = static_cast<SequenceNode*>(node);
+
+        std::vector<Node*> nodes;
+
+        for (size_t i = 0; i < sn->nodes.size(); i++)
+        {
+            Node* n = statement(sn->nodes[i]);
+
+            // Blocks don't scope variables at run time, so the body a
+            // branch turned into goes in as it is
+            if (n && n->type == Node::SEQUENCE)
+            {
+                const std::vector<Node*>& inner = static_cast<SequenceNode*>(n)->nodes;
+
+                nodes.insert(nodes.end(), inner.begin(), inner.end());
+            }
+            else if (n)
+            {
+                nodes.push_back(n);
+            }
+
+            if (n && never_ends(n) && i + 1 < sn->nodes.size())
+            {
+                changed += sn->nodes.size() - i - 1;
+
+                break;
+            }
+        }
+
+        sn->nodes = nodes;
+    }
+        break;
+    case Node::DECLVAR:
+    {
+        DeclareVariableNode* dvn = static_cast<DeclareVariableNode*>(node);
+
+        if (dvn->expression)
+        {
+            dvn->expression = expr(dvn->expression);
+        }
+
+        if (dvn->slot >= 0 && dvn->vartype.is_num())
+        {
+            if (size_t(dvn->slot) >= declared.size())
+            {
+                declared.resize(dvn->slot + 1);
+            }
+
+            declared[dvn->slot] = true;
+        }
+    }
+        break;
+    case Node::ASSIGN:
+    {
+        AssignNode* an = static_cast<AssignNode*>(node);
+
+        an->right = expr(an->right);
+    }
+        break;
+    case Node::PRINT:
+    {
+        PrintNode* pn = static_cast<PrintNode*>(node);
+
+        for (size_t i = 0; i < pn->expressions.size(); i++)
+        {
+            pn->expressions[i] = expr(pn->expressions[i]);
+        }
+    }
+        break;
+    case Node::BRANCHING:
+    {
+        BranchingNode* bn = static_cast<BranchingNode*>(node);
+
+        bn->statement = expr(bn->statement);
+
+        switch (truth(bn->statement))
+        {
+        case IS_TRUE:
+            changed++;
+            return statement(bn->if_body);
+        case IS_FALSE:
+            changed++;
+            return statement(bn->else_body);
+        default:
+            break;
+        }
+
+        // Only one of the bodies runs, declarations in them aren't certain
+        // after the branch
+        std::vector<bool> before = declared;
+
+        bn->if_body = block(bn->if_body);
+        declared = before;
+
+        if (bn->else_body)
+        {
+            bn->else_body = statement(bn->else_body);
+            declared = before;
+
+            if (!bn->else_body || is_empty(bn->else_body))
+            {
+                changed++;
+                bn->else_body = 0;
+            }
+        }
+
+        if (is_empty(bn->if_body) && !bn->else_body && !may_throw(bn->statement))
+        {
+            changed++;
+            return 0;
+        }
+    }
+        break;
+    case Node::FORCYCLE:
+    {
+        ForCycleNode* fcn = static_cast<ForCycleNode*>(node);
+
+        fcn->init = block(fcn->init);
+        fcn->condition = expr(fcn->condition);
+
+        Truth condition = truth(fcn->condition);
+
+        // Only the initialization runs
+        if (condition == IS_FALSE)
+        {
+            changed++;
+            return is_empty(fcn->init) ? 0 : fcn->init;
+        }
+
+        // The body runs at least once when the condition always holds
+        std::vector<bool> before = declared;
+
+        fcn->body = block(fcn->body);
+        fcn->step = block(fcn->step);
+
+        if (condition != IS_TRUE)
+        {
+            declared = before;
+        }
+    }
+        break;
+    case Node::WHILECYCLE:
+    {
+        WhileCycleNode* wcn = static_cast<WhileCycleNode*>(node);
+
+        wcn->condition = expr(wcn->condition);
+
+        Truth condition = truth(wcn->condition);
+
+        if (condition == IS_FALSE)
+        {
+            changed++;
+            return 0;
+        }
+
+        std::vector<bool> before = declared;
+
+        wcn->body = block(wcn->body);
+
+        if (condition != IS_TRUE)
+        {
+            declared = before;
+        }
+    }
+        break;
+    }
+
+    return node;
+}
+
+Node* Optimizer::expr(Node* node)
+{
+    if (!node)
+    {
+        return node;
+    }
+
+    switch (node->type)
+    {
+    case Node::SUM:
+    case Node::SUBTRACT:
+    case Node::MULTIPLICATION:
+    case Node::DIVISION:
+    {
+        BinaryNode* bn = static_cast<BinaryNode*>(node);
+
+        bn->left = expr(bn->left);
+        bn->right = expr(bn->right);
+
+        Node* folded = fold(bn);
+
+        if (folded)
+        {
+            changed++;
+
+            return folded;
+        }
+
+        return simplify(bn);
+    }
+    case Node::EQUALS:
+    case Node::GREATER:
+    case Node::GOQ:
+    case Node::LESSER:
+    case Node::LOQ:
+    case Node::OR:
+    case Node::AND:
+    {
+        BinaryNode* bn = static_cast<BinaryNode*>(node);
+
+        bn->left = expr(bn->left);
+        bn->right = expr(bn->right);
+    }
+        break;
+    }
+
+    return node;
+}
+
+Node* Optimizer::fold(BinaryNode* node)
+{
+    if (!is_constant(node->left) || !is_constant(node->right))
+    {
+        return 0;
+    }
+
+    if (node->valtype == Type::INTEGER)
+    {
+        // Wrapping as the interpreter's int arithmetic does, without
+        // overflowing here
+        unsigned l = unsigned(static_cast<const IntNumNode*>(node->left)->val);
+        unsigned r = unsigned(static_cast<const IntNumNode*>(node->right)->val);
+
+        switch (node->type)
+        {
+        case Node::SUM:
+            return arena.make<IntNumNode>(int(l + r));
+        case Node::SUBTRACT:
+            return arena.make<IntNumNode>(int(l - r));
+        case Node::MULTIPLICATION:
+            return arena.make<IntNumNode>(int(l * r));
+        default:
+            return 0;
+        }
+    }
+
+    float l = float_value(node->left);
+    float r = float_value(node->right);
+
+    switch (node->type)
+    {
+    case Node::SUM:
+        return arena.make<FloatNumNode>(l + r);
+    case Node::SUBTRACT:
+        return arena.make<FloatNumNode>(l - r);
+    case Node::MULTIPLICATION:
+        return arena.make<FloatNumNode>(l * r);
+    case Node::DIVISION:
+        if (r == 0.f)
+        {
+            return 0;
+        }
+        return arena.make<FloatNumNode>(l / r);
+    default:
+        return 0;
+    }
+}
+
+Node* Optimizer::simplify(BinaryNode* node)
+{
+    // A replacement has to give the same Type::Types, x * 1.0 of an integer
+    // x is a float
+    if (is_constant(node->right))
+    {
+        float c = float_value(node->right);
+        Node* x = node->left;
+
+        switch (node->type)
+        {
+        case Node::SUM:
+            // -0. + 0 is 0., only integers keep their value
+            if (c == 0.f && node->valtype == Type::INTEGER)
+            {
+                changed++;
+                return x;
+            }
+            break;
+        case Node::SUBTRACT:
+            // -0. - -0. is 0., only x - 0. keeps the sign of x
+            if (c == 0.f && !std::signbit(c) && x->valtype == node->valtype)
+            {
+                changed++;
+                return x;
+            }
+            break;
+        case Node::MULTIPLICATION:
+            if (c == 1.f && x->valtype == node->valtype)
+            {
+                changed++;
+                return x;
+            }
+            if (c == 0.f && node->valtype == Type::INTEGER && !may_throw(x))
+            {
+                changed++;
+                return node->right;
+            }
+            break;
+        case Node::DIVISION:
+        {
+            float reciprocal;
+
+            if (exact_reciprocal(c, reciprocal))
+            {
+                // Without the division's check for 0 nothing is left to
+                // throw, and x runs first either way
+                changed++;
+                return simplify(arena.make<MultiplicationNode>(x, arena.make<FloatNumNode>(reciprocal)));
+            }
+        }
+            break;
+        }
+    }
+    else if (is_constant(node->left))
+    {
+        float c = float_value(node->left);
+        Node* x = node->right;
+
+        switch (node->type)
+        {
+        case Node::SUM:
+            if (c == 0.f && node->valtype == Type::INTEGER)
+            {
+                changed++;
+                return x;
+            }
+            break;
+        case Node::MULTIPLICATION:
+            if (c == 1.f && x->valtype == node->valtype)
+            {
+                changed++;
+                return x;
+            }
+            if (c == 0.f && node->valtype == Type::INTEGER && !may_throw(x))
+            {
+                changed++;
+                return node->left;
+            }
+            break;
+        }
+    }
+
+    return node;
+}
+
+// Comparisons, && and ||, which give a bool rather than a number
+static bool is_condition(const Node* node)
+{
+    return node->type >= Node::EQUALS && node->type <= Node::AND;
+}
+
+bool Optimizer::may_throw(const Node* node) const
+{
+    switch (node->type)
+    {
+    case Node::INTEGER:
+    case Node::FLOAT:
+        return false;
+    case Node::VAR:
+    {
+        const VariableNode* vn = static_cast<const VariableNode*>(node);
+
+        return !vn->vartype.is_num() || vn->slot < 0 || size_t(vn->slot) >= declared.size() || !declared[vn->slot];
+    }
+    case Node::SUM:
+    case Node::SUBTRACT:
+    case Node::MULTIPLICATION:
+    case Node::EQUALS:
+    case Node::GREATER:
+    case Node::GOQ:
+    case Node::LESSER:
+    case Node::LOQ:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        return is_condition(bn->left) || is_condition(bn->right) || may_throw(bn->left) || may_throw(bn->right);
+    }
+    case Node::OR:
+    case Node::AND:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        return !is_condition(bn->left) || !is_condition(bn->right) || may_throw(bn->left) || may_throw(bn->right);
+    }
+    default:
+        return true;
+    }
+}
+
+Optimizer::Truth Optimizer::truth(const Node* node) const
+{
+    switch (node->type)
+    {
+    case Node::AND:
+    case Node::OR:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        // A number where a condition should be throws when it is reached
+        if (!is_condition(bn->left) || !is_condition(bn->right))
+        {
+            return UNKNOWN;
+        }
+
+        // The value that decides the whole condition, && stops at false
+        // and || at true
+        Truth decides = node->type == Node::AND ? IS_FALSE : IS_TRUE;
+
+        Truth left = truth(bn->left);
+
+        if (left == decides)
+        {
+            return left;
+        }
+
+        Truth right = truth(bn->right);
+
+        if (left != UNKNOWN)
+        {
+            return right;
+        }
+
+        // Left has to run, but can't change the outcome
+        if (right == decides && !may_throw(bn->left))
+        {
+            return right;
+        }
+
+        return UNKNOWN;
+    }
+    case Node::EQUALS:
+    case Node::GREATER:
+    case Node::GOQ:
+    case Node::LESSER:
+    case Node::LOQ:
+    {
+        const BinaryNode* bn = static_cast<const BinaryNode*>(node);
+
+        if (!is_constant(bn->left) || !is_constant(bn->right))
+        {
+            return UNKNOWN;
+        }
+
+        bool result;
+
+        // Integers compare as integers, as in Interpreter::calc_logic()
+        if (bn->left->type == Node::INTEGER && bn->right->type == Node::INTEGER)
+        {
+            int l = static_cast<const IntNumNode*>(bn->left)->val;
+            int r = static_cast<const IntNumNode*>(bn->right)->val;
+
+            switch (node->type)
+            {
+            case Node::EQUALS: result = l == r; break;
+            case Node::GREATER: result = l > r; break;
+            case Node::GOQ: result = l >= r; break;
+            case Node::LESSER: result = l < r; break;
+            default: result = l <= r; break;
+            }
+        }
+        else
+        {
+            float l = float_value(bn->left);
+            float r = float_value(bn->right);
+
+            switch (node->type)
+            {
+            case Node::EQUALS: result = l == r; break;
+            case Node::GREATER: result = l > r; break;
+            case Node::GOQ: result = l >= r; break;
+            case Node::LESSER: result = l < r; break;
+            default: result = l <= r; break;
+            }
+        }
+
+        return result ? IS_TRUE : IS_FALSE;
+    }
+    default:
+        return UNKNOWN;
+    }
+}
+
+bool Optimizer::never_ends(const Node* node) const
+{
+    switch (node->type)
+    {
+    case Node::FORCYCLE:
+        return truth(static_cast<const ForCycleNode*>(node)->condition) == IS_TRUE;
+    case Node::WHILECYCLE:
+        return truth(static_cast<const WhileCycleNode*>(node)->condition) == IS_TRUE;
+    case Node::SEQUENCE:
+    {
+        const std::vector<Node*>& nodes = static_cast<const SequenceNode*>(node)->nodes;
+
+        return !nodes.empty() && never_ends(nodes.back());
+    }
+    default:
+        return false;
+    }
+}
@@ -1,8 +1,8 @@
 #include <Parser.h>
 
-UnexpectedTokenError::UnexpectedTokenError(Token t, Token expected)
+UnexpectedTokenError::UnexpectedTokenError(Token t, SourcePosition pos, Token expected)
 {
-    err = "Unexpected token " + t.to_string() + " at " + std::to_string(t.line) + " line, " + std::to_string(t.chr) + " column";
+    err = "Unexpected token " + t.to_string() + " at " + pos.to_string();
 
     if (expected.type != Token::EMPTY)
     {
@@ -10,7 +10,18 @@ UnexpectedTokenError::UnexpectedTokenError(Token t, Token expected)
     }
 }
 
-Parser::Parser(std::vector<Token> tokens) : position(0), tokens(tokens)
+Parser::Parser(std::vector<Token> tokens, LineIndex* lines) : owned_source(new VectorTokenSource(std::move(tokens))), source(owned_source.get()), 
+tokens(&window), position(0), arena(std::make_shared<AstArena>()), resolver(std::make_shared<Resolver>()), lines(lines), listener(0), last_offset(0), recovering(false)
+{
+    fill();
+}
+
+Parser::Parser(TokenSource& source, LineIndex* lines) : source(&source), tokens(&window), position(0), arena(std::make_shared<AstArena>()), resolver(std::make_shared<Resolver>()), lines(lines), listener(0), last_offset(0), recovering(false)
+{
+    fill();
+}
+
+Parser::Parser(const TokenBuffer& tokens, LineIndex* lines) : source(0), tokens(&tokens), position(0), arena(std::make_shared<AstArena>()), resolver(std::make_shared<Resolver>()), lines(lines), listener(0), last_offset(0), recovering(false)
 {
 
 }
@@ -20,9 +31,9 @@ Parser::~Parser()
 
 }
 
-std::shared_ptr<Node> Parser::make_node()
+Node* Parser::make_node()
 {
-    switch(cur_token().type)
+    switch(cur_type())
     {
     case Token::INTTYPE:
     case Token::FLOATTYPE:
@@ -45,44 +56,70 @@ std::shared_ptr<Node> Parser::make_node()
         break;
     }
 
-    return std::shared_ptr<Node>(0);
+    return 0;
 }
 
 std::shared_ptr<SequenceNode> Parser::make_tree(const std::unordered_map<std::string, std::shared_ptr<Type>>& variables)
 {
-    std::shared_ptr<SequenceNode> s_node(new SequenceNode({}, variables));
+    SequenceNode* s_node = make_sequence(variables);
+
+    if (!diagnostics.empty())
+    {
+        diagnostics.front()->raise();
+    }
+
+    return std::shared_ptr<SequenceNode>(arena, s_node);
+}
+
+SequenceNode* Parser::make_sequence(const std::unordered_map<std::string, std::shared_ptr<Type>>& variables)
+{
+    SequenceNode* s_node = arena->make<SequenceNode>(std::vector<Node*>(), variables);
 
     sequence_nodes.push_back(s_node);
 
-    while(position < tokens.size() && cur_token().type != Token::RBRACE)
+    if (listener)
     {
-        std::shared_ptr<Node> n = make_node();
+        listener->enter_block(last_offset + 1);
+    }
 
-        if (n)
-        {
-            s_node->nodes.push_back(n);
-        }
+    while(has_token() && cur_type() != Token::RBRACE)
+    {
+        size_t begin = tokens->offset(position);
 
-        try
-        {
-            expect_token(Token::SEMICOLON);
-        }
-        catch (const EndOfFileError& e)
+        Node* n = make_node();
+
+        if (!recovering && expect_token(Token::SEMICOLON))
         {
-            return s_node;
+            if (n)
+            {
+                s_node->nodes.push_back(n);
+            }
+
+            if (listener)
+            {
+                listener->statement(begin, last_offset + 1, n);
+            }
+
+            continue;
         }
+
+        synchronize();
+    }
+
+    if (listener)
+    {
+        listener->leave_block(has_token() ? tokens->offset(position) : last_offset + 1, s_node);
     }
 
     return s_node;
 }
 
-std::shared_ptr<DeclareVariableNode> Parser::make_variable()
+DeclareVariableNode* Parser::make_variable()
 {
     Type vartype;
-    std::string name = "";
-    std::shared_ptr<Node> expression = 0;
+    Node* expression = 0;
 
-    switch(cur_token().type)
+    switch(cur_type())
     {
     case Token::INTTYPE:
         vartype.type = Type::INTEGER;
@@ -91,314 +128,352 @@ std::shared_ptr<DeclareVariableNode> Parser::make_variable()
         vartype.type = Type::FLOAT;
         break;
     default:
-        throw UnexpectedTokenError(cur_token());
-        break;
+        unexpected();
+        return 0;
     }
 
     advance();
 
-    name = expect_token(Token::STRING).sval;
+    Token t = cur_token();
 
-    if (cur_token().type == Token::EQUAL)
+    if (!expect_token(Token::STRING))
+    {
+        return 0;
+    }
+
+    std::string name = t.name();
+
+    if (cur_type() == Token::EQUAL)
     {
         advance();
 
         expression = make_expression(vartype);
     }
 
-    std::shared_ptr<Type> t(new Type);
+    // Declared even when the expression is broken, so that later
+    // statements don't report the name as undefined
+    std::shared_ptr<Type> declared(new Type);
 
-    memcpy(t.get(), &vartype, sizeof(Type));
+    memcpy(declared.get(), &vartype, sizeof(Type));
 
-    cur_sequence_node()->variables[name] = t;
+    cur_sequence_node()->variables[name] = declared;
 
-    return std::shared_ptr<DeclareVariableNode>(new DeclareVariableNode(vartype, name, expression));
+    if (recovering)
+    {
+        return 0;
+    }
+
+    return arena->make<DeclareVariableNode>(vartype, name, expression, resolver->slot(name));
 }
 
-std::shared_ptr<PrintNode> Parser::make_print()
+PrintNode* Parser::make_print()
 {
-    std::shared_ptr<PrintNode> out(new PrintNode());
-
-    expect_token(Token::PRINT);
+    PrintNode* out = arena->make<PrintNode>();
 
-    expect_token(Token::LPARENTHESIS);
+    if (!expect_token(Token::PRINT) || !expect_token(Token::LPARENTHESIS))
+    {
+        return 0;
+    }
 
-    while(cur_token().type != Token::RPARENTHESIS)
+    while(cur_type() != Token::RPARENTHESIS)
     {
-        switch (cur_token().type)
+        Node* expression = 0;
+
+        switch (cur_type())
         {
         case Token::INTEGER:
         case Token::FLOAT:
         case Token::LPARENTHESIS:
-            out->expressions.push_back(make_expression(Type(Type::FLOAT)));
+            expression = make_expression(Type(Type::FLOAT));
             break;
         case Token::STRING:
         {
-            Type vartype = get_var(cur_token().sval);
+            Type vartype;
+
+            if (!get_var(cur_token().name(), vartype))
+            {
+                error(UndefinedNameError(cur_token(), locate(cur_token())));
+                return 0;
+            }
 
-            out->expressions.push_back(make_expression(vartype));
+            expression = make_expression(vartype);
         }
             break;
         default:
-            throw UnexpectedTokenError(cur_token());
-            break;
+            unexpected();
+            return 0;
+        }
+
+        if (!expression)
+        {
+            return 0;
         }
 
-        expect_tokens({ Token::COMMA, Token::RPARENTHESIS });
+        out->expressions.push_back(expression);
 
-        if (cur_token().type == Token::COMMA)
+        if (cur_type() == Token::COMMA)
         {
             advance();
         }
+        else if (cur_type() != Token::RPARENTHESIS)
+        {
+            unexpected();
+            return 0;
+        }
     }
 
     advance();
 
     if (out->expressions.empty()) // print()
     {
-        throw ParserException("Expected expression inside \'print\' function");
+        error(ParserException("Expected expression inside \'print\' function"));
+        return 0;
     }
 
     return out;
 }
 
-std::shared_ptr<Node> Parser::make_expression(Type type)
+Node* Parser::make_expression(Type type)
 {
-    switch(type.type)
+    if (type.type == Type::BOOL)
     {
-    case Type::INTEGER:
-    case Type::FLOAT:
-        return expr();
-        break;
-    case Type::BOOL:
         return logical_expr();
-        break;
     }
+
+    return expr();
 }
 
-std::shared_ptr<AssignNode> Parser::make_assign()
+AssignNode* Parser::make_assign()
 {
-    Token t = expect_token(Token::STRING);
+    Token t = cur_token();
+
+    if (!expect_token(Token::STRING))
+    {
+        return 0;
+    }
 
     Type vartype;
-    std::string name = t.sval;
+    const std::string& name = t.name();
 
-    try
+    if (!get_var(name, vartype))
     {
-        vartype = get_var(name);
+        error(UndefinedNameError(t, locate(t)));
+        return 0;
     }
-    catch(const std::exception& e)
+
+    if (!expect_token(Token::EQUAL))
     {
-        throw UndefinedNameError(t);
+        return 0;
     }
 
-    expect_token(Token::EQUAL);
+    Node* expression = make_expression(vartype);
 
-    return std::shared_ptr<AssignNode>(new AssignNode(std::shared_ptr<Node>(new VariableNode(name, vartype)), make_expression(vartype)));
+    if (!expression)
+    {
+        return 0;
+    }
+
+    return arena->make<AssignNode>(arena->make<VariableNode>(name, vartype, resolver->slot(name)), expression);
 }
 
-std::shared_ptr<BranchingNode> Parser::make_branching()
+BranchingNode* Parser::make_branching()
 {
-    expect_token(Token::IF);
-
-    expect_token(Token::LPARENTHESIS);
-
-    std::shared_ptr<Node> statement = make_expression(BOOL_TYPE);
-
-    expect_token(Token::RPARENTHESIS);
-
-    expect_token(Token::LBRACE);
+    if (!expect_token(Token::IF) || !expect_token(Token::LPARENTHESIS))
+    {
+        return 0;
+    }
 
-    std::shared_ptr<Node> if_body = make_tree();
+    Node* statement = make_expression(BOOL_TYPE);
 
-    expect_token(Token::RBRACE);
+    if (!statement || !expect_token(Token::RPARENTHESIS) || !expect_token(Token::LBRACE))
+    {
+        return 0;
+    }
 
-    expect_token(Token::ELSE);
+    Node* if_body = make_sequence();
 
-    expect_token(Token::LBRACE);
+    if (!expect_token(Token::RBRACE) || !expect_token(Token::ELSE) || !expect_token(Token::LBRACE))
+    {
+        return 0;
+    }
 
-    std::shared_ptr<Node> else_body = make_tree();
+    Node* else_body = make_sequence();
 
-    expect_token(Token::RBRACE);
+    if (!expect_token(Token::RBRACE))
+    {
+        return 0;
+    }
 
-    return std::shared_ptr<BranchingNode>(new BranchingNode(statement, if_body, else_body));
+    return arena->make<BranchingNode>(statement, if_body, else_body);
 }
 
-std::shared_ptr<ForCycleNode> Parser::make_for_cycle()
+ForCycleNode* Parser::make_for_cycle()
 {
-    expect_token(Token::FOR);
-
-    expect_token(Token::LPARENTHESIS);
-
-    std::shared_ptr<Node> init = make_node();
+    if (!expect_token(Token::FOR) || !expect_token(Token::LPARENTHESIS))
+    {
+        return 0;
+    }
 
-    expect_token(Token::SEMICOLON);
+    Node* init = make_node();
 
-    std::shared_ptr<Node> condition = make_expression(BOOL_TYPE);
+    if (recovering || !expect_token(Token::SEMICOLON))
+    {
+        return 0;
+    }
 
-    expect_token(Token::SEMICOLON);
+    Node* condition = make_expression(BOOL_TYPE);
 
-    std::shared_ptr<Node> step = make_node();
+    if (!condition || !expect_token(Token::SEMICOLON))
+    {
+        return 0;
+    }
 
-    expect_token(Token::RPARENTHESIS);
+    Node* step = make_node();
 
-    expect_token(Token::LBRACE);
+    if (recovering || !expect_token(Token::RPARENTHESIS) || !expect_token(Token::LBRACE))
+    {
+        return 0;
+    }
 
-    std::shared_ptr<SequenceNode> body = make_tree();
+    SequenceNode* body = make_sequence();
 
-    expect_token(Token::RBRACE);
+    if (!expect_token(Token::RBRACE))
+    {
+        return 0;
+    }
 
-    return std::shared_ptr<ForCycleNode>(new ForCycleNode(init, condition, step, body));
+    return arena->make<ForCycleNode>(init, condition, step, body);
 }
 
-std::shared_ptr<WhileCycleNode> Parser::make_while_cycle()
+WhileCycleNode* Parser::make_while_cycle()
 {
-    expect_token(Token::WHILE);
-
-    expect_token(Token::LPARENTHESIS);
+    if (!expect_token(Token::WHILE) || !expect_token(Token::LPARENTHESIS))
+    {
+        return 0;
+    }
 
-    std::shared_ptr<Node> condition = make_expression(BOOL_TYPE);
-    
-    expect_token(Token::RPARENTHESIS);
+    Node* condition = make_expression(BOOL_TYPE);
 
-    expect_token(Token::LBRACE);
+    if (!condition || !expect_token(Token::RPARENTHESIS) || !expect_token(Token::LBRACE))
+    {
+        return 0;
+    }
 
-    std::shared_ptr<SequenceNode> body = make_tree();
+    SequenceNode* body = make_sequence();
 
-    expect_token(Token::RBRACE);
+    if (!expect_token(Token::RBRACE))
+    {
+        return 0;
+    }
 
-    return std::shared_ptr<WhileCycleNode>(new WhileCycleNode(condition, body));
+    return arena->make<WhileCycleNode>(condition, body);
 }
 
-std::shared_ptr<Node> Parser::logical_expr()
+// Comparisons bind loosest and && / || sit between them and arithmetic,
+// all of them left associative
+enum Precedence
+{
+    PRECEDENCE_NONE = 0,
+    PRECEDENCE_COMPARISON,
+    PRECEDENCE_LOGICAL,
+    PRECEDENCE_ADDITIVE,
+    PRECEDENCE_MULTIPLICATIVE
+};
+
+struct BinaryOperator
+{
+    int precedence;
+    Node* (*make)(AstArena& arena, Node* left, Node* right);
+};
+
+template <class T>
+static Node* make_binary(AstArena& arena, Node* left, Node* right)
 {
-    std::shared_ptr<Node> result = logical_term();
+    return arena.make<T>(left, right);
+}
 
-    while (cur_token().type == Token::GREATER || cur_token().type == Token::GOQ || 
-    cur_token().type == Token::LESSER || cur_token().type == Token::LOQ || 
-    cur_token().type == Token::EQEQ)
+// Indexed by token type, tokens that aren't binary operators have
+// PRECEDENCE_NONE
+struct BinaryOperatorTable
+{
+    BinaryOperatorTable()
     {
-        switch (cur_token().type)
+        for (int i = 0; i < Token::TYPES_COUNT; i++)
         {
-        case Token::EQEQ:
-            advance();
-            result = std::shared_ptr<Node>(new EqualsNode(result, logical_term()));
-            break;
-        case Token::GREATER:
-            advance();
-            result = std::shared_ptr<Node>(new GreaterNode(result, logical_term()));
-            break;
-        case Token::GOQ:
-            advance();
-            result =  std::shared_ptr<Node>(new GOQNode(result, logical_term()));
-            break;
-        case Token::LESSER:
-            advance();
-            result =  std::shared_ptr<Node>(new LesserNode(result, logical_term()));
-            break;
-        case Token::LOQ:
-            advance();
-            result =  std::shared_ptr<Node>(new LOQNode(result, logical_term()));
-            break;
-        default:
-            break;
+            entries[i].precedence = PRECEDENCE_NONE;
+            entries[i].make = 0;
         }
-    }
 
-    return result;
-}
+        add(Token::EQEQ, PRECEDENCE_COMPARISON, &make_binary<EqualsNode>);
+        add(Token::GREATER, PRECEDENCE_COMPARISON, &make_binary<GreaterNode>);
+        add(Token::GOQ, PRECEDENCE_COMPARISON, &make_binary<GOQNode>);
+        add(Token::LESSER, PRECEDENCE_COMPARISON, &make_binary<LesserNode>);
+        add(Token::LOQ, PRECEDENCE_COMPARISON, &make_binary<LOQNode>);
 
-std::shared_ptr<Node> Parser::logical_term()
-{
-    std::shared_ptr<Node> result = logical_fact();
+        add(Token::AND, PRECEDENCE_LOGICAL, &make_binary<ANDNode>);
+        add(Token::ANDAND, PRECEDENCE_LOGICAL, &make_binary<ANDNode>);
+        add(Token::OR, PRECEDENCE_LOGICAL, &make_binary<ORNode>);
+        add(Token::OROR, PRECEDENCE_LOGICAL, &make_binary<ORNode>);
+
+        add(Token::PLUS, PRECEDENCE_ADDITIVE, &make_binary<SumNode>);
+        add(Token::MINUS, PRECEDENCE_ADDITIVE, &make_binary<SubtractNode>);
+
+        add(Token::ASTERISK, PRECEDENCE_MULTIPLICATIVE, &make_binary<MultiplicationNode>);
+        add(Token::SLASH, PRECEDENCE_MULTIPLICATIVE, &make_binary<DivisionNode>);
+    }
 
-    while (cur_token().type == Token::AND || cur_token().type == Token::OR || cur_token().type == Token::ANDAND || cur_token().type == Token::OROR)
+    void add(int token_type, int precedence, Node* (*make)(AstArena&, Node*, Node*))
     {
-        switch (cur_token().type)
-        {
-        case Token::AND: case Token::ANDAND:
-            advance();
-            result = std::shared_ptr<Node>(new ANDNode(result, logical_fact()));
-            break;
-        case Token::OR: case Token::OROR:
-            advance();
-            result = std::shared_ptr<Node>(new ORNode(result, logical_fact()));
-            break;
-        default:
-            break;
-        }
+        entries[token_type].precedence = precedence;
+        entries[token_type].make = make;
     }
 
-    return result;
-}
+    const BinaryOperator& operator[](int token_type) const
+    {
+        static const BinaryOperator none = { PRECEDENCE_NONE, 0 };
 
-std::shared_ptr<Node> Parser::logical_fact()
-{
-    Token t = cur_token();
+        return unsigned(token_type) < unsigned(Token::TYPES_COUNT) ? entries[token_type] : none;
+    }
 
-    if (cur_token().type == Token::LPARENTHESIS)
-    {
-        advance();
+    BinaryOperator entries[Token::TYPES_COUNT];
+};
 
-        std::shared_ptr<Node> result = logical_expr();
+static const BinaryOperatorTable binary_operators;
 
-        expect_token(Token::RPARENTHESIS);
+Node* Parser::logical_expr()
+{
+    return binary(PRECEDENCE_COMPARISON, PRECEDENCE_COMPARISON);
+}
 
-        return result;
-    }
-    
-    return expr();
+Node* Parser::expr()
+{
+    return binary(PRECEDENCE_ADDITIVE, PRECEDENCE_ADDITIVE);
 }
 
-std::shared_ptr<Node> Parser::expr()
+Node* Parser::binary(int min_precedence, int lowest)
 {
-    std::shared_ptr<Node> result = term();
+    Node* result = operand(lowest);
 
-    while (cur_token().type == Token::PLUS || cur_token().type == Token::MINUS)
+    while (result)
     {
-        switch (cur_token().type)
+        const BinaryOperator& op = binary_operators[cur_type()];
+
+        if (op.precedence < min_precedence)
         {
-        case Token::PLUS:
-            advance();
-            result = std::shared_ptr<Node>(new SumNode(result, term()));
-            break;
-        case Token::MINUS:
-            advance();
-            result = std::shared_ptr<Node>(new SubtractNode(result, term()));
-            break;
-        default:
-            break;
+            return result;
         }
-    }
 
-    return result;
-}
+        advance();
 
-std::shared_ptr<Node> Parser::term()
-{
-    std::shared_ptr<Node> result = fact();
+        Node* right = binary(op.precedence + 1, lowest);
 
-    while (cur_token().type == Token::ASTERISK || cur_token().type == Token::SLASH)
-    {
-        switch (cur_token().type)
-        {
-        case Token::ASTERISK:
-            advance();
-            result = std::shared_ptr<Node>(new MultiplicationNode(result, fact()));
-            break;
-        case Token::SLASH:
-            advance();
-            result = std::shared_ptr<Node>(new DivisionNode(result, fact()));
-            break;
-        default:
-            break;
-        }
+        result = right ? op.make(*arena, result, right) : 0;
     }
 
-    return result;
+    return 0;
 }
 
-std::shared_ptr<Node> Parser::fact()
+Node* Parser::operand(int lowest)
 {
     Token t = cur_token();
 
@@ -406,100 +481,165 @@ std::shared_ptr<Node> Parser::fact()
     {
         advance();
 
-        std::shared_ptr<Node> result = expr();
+        Node* result = binary(lowest, lowest);
 
-        expect_token(Token::RPARENTHESIS);
+        if (!result || !expect_token(Token::RPARENTHESIS))
+        {
+            return 0;
+        }
 
         return result;
     }
-    else if (t.type == Token::INTEGER || t.type == Token::FLOAT)
+    else if (t.type == Token::INTEGER)
     {
         advance();
-        switch (t.type)
-        {
-        case Token::INTEGER:
-            return std::shared_ptr<Node>(new IntNumNode(t.ival));
-            break;
-        case Token::FLOAT:
-            return std::shared_ptr<Node>(new FloatNumNode(t.fval));
-            break;
-        default:
-            break;
-        }
+
+        return arena->make<IntNumNode>(t.ival);
     }
-    else if (t.type == Token::STRING)
+    else if (t.type == Token::FLOAT)
     {
         advance();
 
-        Type vartype = get_var(t.sval);
+        return arena->make<FloatNumNode>(t.fval);
+    }
+    else if (t.type == Token::STRING)
+    {
+        Type vartype;
 
-        if (vartype.type == Type::INTEGER || vartype.type == Type::FLOAT)
+        if (!get_var(t.name(), vartype))
         {
-            return std::shared_ptr<Node>(new VariableNode(t.sval, vartype));
+            error(UndefinedNameError(t, locate(t)));
+            return 0;
         }
-        else
+
+        advance();
+
+        if (vartype.type == Type::INTEGER || vartype.type == Type::FLOAT)
         {
-            throw VariableTypeError(Type(Type::FLOAT), vartype, t);
+            return arena->make<VariableNode>(t.name(), vartype, resolver->slot(t.name()));
         }
+
+        error(VariableTypeError(Type(Type::FLOAT), vartype, locate(t)));
+        return 0;
     }
 
-    throw UnexpectedTokenError(t);
+    unexpected();
+    return 0;
 }
 
 void Parser::advance()
 {
+    if (!has_token())
+    {
+        return;
+    }
+
+    last_offset = tokens->offset(position);
+
     position++;
 
-    if (position >= tokens.size())
+    if (position >= tokens->size())
     {
-        throw EndOfFileError();
+        fill();
     }
 }
 
-Type Parser::get_var(const std::string& name) const
+bool Parser::fill()
 {
-    std::shared_ptr<Type> vartype;
-
-    try
+    if (!source)
     {
-        vartype = cur_sequence_node()->variables.at(name);
+        return false;
     }
-    catch(const std::exception& e)
+
+    window.clear();
+    position = 0;
+
+    Token t;
+
+    while (window.size() < WINDOW_SIZE && source->next_token(t))
     {
-        throw UndefinedNameError(cur_token());
+        window.push_back(t);
     }
-    
-    return *vartype.get();
+
+    return !window.empty();
 }
 
-void Parser::expect_tokens(const std::vector<int>& tokens_types)
+bool Parser::get_var(const std::string& name, Type& out) const
 {
-    for (auto i : tokens_types)
+    const std::unordered_map<std::string, std::shared_ptr<Type>>& variables = cur_sequence_node()->variables;
+
+    std::unordered_map<std::string, std::shared_ptr<Type>>::const_iterator found = variables.find(name);
+
+    if (found == variables.end())
     {
-        if (cur_token().type == i)
-        {
-            return;
-        }
+        return false;
     }
 
-    throw UnexpectedTokenError(cur_token());
+    out = *found->second;
+
+    return true;
 }
 
-Token Parser::expect_token(int token_type)
+void Parser::unexpected(int expected_type)
 {
-    if (cur_token().type != token_type)
+    if (!has_token())
     {
-        if (token_type == Token::STRING)
+        error(EndOfFileError());
+    }
+    else
+    {
+        error(UnexpectedTokenError(cur_token(), locate(cur_token()), Token(expected_type)));
+    }
+}
+
+void Parser::synchronize()
+{
+    int depth = 0;
+
+    while (has_token())
+    {
+        switch (cur_type())
         {
-            throw UnexpectedTokenError(cur_token());
+        case Token::LBRACE:
+            depth++;
+            break;
+        case Token::RBRACE:
+            if (depth == 0)
+            {
+                recovering = false;
+                return;
+            }
+
+            depth--;
+            break;
+        case Token::SEMICOLON:
+            if (depth == 0)
+            {
+                advance();
+
+                recovering = false;
+                return;
+            }
+            break;
         }
 
-        throw UnexpectedTokenError(cur_token(), Token(token_type));
+        advance();
     }
 
-    Token t = cur_token();
+    recovering = false;
+}
 
-    advance();
+bool Parser::expect_token(int token_type)
+{
+    if (cur_type() == token_type)
+    {
+        advance();
+
+        return true;
+    }
+
+    // Names are never shown as expected
+    unexpected(token_type == Token::STRING ? int(Token::EMPTY) : token_type);
 
-    return t;
-}
\ No newline at end of file
+    return false;
+}
@@ -0,0 +1,103 @@
+#include <Resolver.h>
+
+int Resolver::slot(const std::string& name)
+{
+    std::unordered_map<std::string, int>::const_iterator found = slots.find(name);
+
+    if (found != slots.end())
+    {
+        return found->second;
+    }
+
+    int slot = int(slots.size());
+
+    slots[name] = slot;
+
+    return slot;
+}
+
+void Resolver::resolve(Node* node)
+{
+    if (!node)
+    {
+        return;
+    }
+
+    switch (node->type)
+    {
+    case Node::VAR:
+    {
+        VariableNode* vn = static_cast<VariableNode*>(node);
+
+        vn->slot = slot(vn->name);
+    }
+        break;
+    case Node::DECLVAR:
+    {
+        DeclareVariableNode* dvn = static_cast<DeclareVariableNode*>(node);
+
+        resolve(dvn->expression);
+
+        dvn->slot = slot(dvn->name);
+    }
+        break;
+    case Node::INTEGER:
+    case Node::FLOAT:
+        break;
+    case Node::SEQUENCE:
+    {
+        SequenceNode* sn = static_cast<SequenceNode*>(node);
+
+        for (size_t i = 0; i < sn->nodes.size(); i++)
+        {
+            resolve(sn->nodes[i]);
+        }
+    }
+        break;
+    case Node::PRINT:
+    {
+        PrintNode* pn = static_cast<PrintNode*>(node);
+
+        for (size_t i = 0; i < pn->expressions.size(); i++)
+        {
+            resolve(pn->expressions[i]);
+        }
+    }
+        break;
+    case Node::BRANCHING:
+    {
+        BranchingNode* bn = static_cast<BranchingNode*>(node);
+
+        resolve(bn->statement);
+        resolve(bn->if_body);
+        resolve(bn->else_body);
+    }
+        break;
+    case Node::FORCYCLE:
+    {
+        ForCycleNode* fcn = static_cast<ForCycleNode*>(node);
+
+        resolve(fcn->init);
+        resolve(fcn->condition);
+        resolve(fcn->step);
+        resolve(fcn->body);
+    }
+        break;
+    case Node::WHILECYCLE:
+    {
+        WhileCycleNode* wcn = static_cast<WhileCycleNode*>(node);
+
+        resolve(wcn->condition);
+        resolve(wcn->body);
+    }
+        break;
+    default: // binary operators
+    {
+        BinaryNode* bn = static_cast<BinaryNode*>(node);
+
+        resolve(bn->left);
+        resolve(bn->right);
+    }
+        break;
+    }
+}
@@ -0,0 +1,296 @@
+#include <Scanner.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCANNER_X86 1
+#define SCANNER_AVX2_TARGET __attribute__((target("avx2")))
+#define SCANNER_CTZ(x) __builtin_ctz(x)
+#define SCANNER_POPCOUNT(x) __builtin_popcount(x)
+#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define SCANNER_X86 1
+#define SCANNER_AVX2_TARGET
+#include <immintrin.h>
+#include <intrin.h>
+static int scanner_ctz(unsigned x) { unsigned long i; _BitScanForward(&i, x); return int(i); }
+#define SCANNER_CTZ(x) scanner_ctz(x)
+#define SCANNER_POPCOUNT(x) __popcnt(x)
+#endif
+
+static bool is_whitespace_char(char c) { return c == ' ' || c == '\n' || c == '\t'; }
+static bool is_identifier_char(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'; }
+static bool is_digit_char(char c) { return c >= '0' && c <= '9'; }
+
+static const char* scalar_whitespace(const char* p, const char* end)
+{
+    while (p < end && is_whitespace_char(*p))
+    {
+        p++;
+    }
+
+    return p;
+}
+
+static const char* scalar_identifier(const char* p, const char* end)
+{
+    while (p < end && is_identifier_char(*p))
+    {
+        p++;
+    }
+
+    return p;
+}
+
+static const char* scalar_digits(const char* p, const char* end)
+{
+    while (p < end && is_digit_char(*p))
+    {
+        p++;
+    }
+
+    return p;
+}
+
+static size_t scalar_count(const char* p, const char* end, char c)
+{
+    size_t n = 0;
+
+    for (; p < end; p++)
+    {
+        n += *p == c;
+    }
+
+    return n;
+}
+
+#ifdef SCANNER_X86
+
+// Unsigned "lo <= c <= hi" for every byte, built from signed compares by
+// shifting the range down to start at -128.
+static __m128i sse2_in_range(__m128i c, char lo, char hi)
+{
+    __m128i shifted = _mm_add_epi8(c, _mm_set1_epi8(char(-128 - lo)));
+
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8(char(-128 + (hi - lo) + 1)));
+}
+
+static __m128i sse2_whitespace_mask(__m128i c)
+{
+    return _mm_or_si128(_mm_or_si128(
+        _mm_cmpeq_epi8(c, _mm_set1_epi8(' ')),
+        _mm_cmpeq_epi8(c, _mm_set1_epi8('\n'))),
+        _mm_cmpeq_epi8(c, _mm_set1_epi8('\t')));
+}
+
+static __m128i sse2_identifier_mask(__m128i c)
+{
+    __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20)); // folds A-Z onto a-z
+
+    return _mm_or_si128(_mm_or_si128(
+        sse2_in_range(lower, 'a', 'z'),
+        sse2_in_range(c, '0', '9')),
+        _mm_cmpeq_epi8(c, _mm_set1_epi8('_')));
+}
+
+static __m128i sse2_digit_mask(__m128i c)
+{
+    return sse2_in_range(c, '0', '9');
+}
+
+#define SSE2_SCANNER(name, mask_fn, scalar_fn) \
+static const char* name(const char* p, const char* end) \
+{ \
+    while (end - p >= 16) \
+    { \
+        unsigned stop = ~unsigned(_mm_movemask_epi8(mask_fn(_mm_loadu_si128((const __m128i*)p)))) & 0xFFFFu; \
+        if (stop) \
+        { \
+            return p + SCANNER_CTZ(stop); \
+        } \
+        p += 16; \
+    } \
+    return scalar_fn(p, end); \
+}
+
+SSE2_SCANNER(sse2_whitespace, sse2_whitespace_mask, scalar_whitespace)
+SSE2_SCANNER(sse2_identifier, sse2_identifier_mask, scalar_identifier)
+SSE2_SCANNER(sse2_digits, sse2_digit_mask, scalar_digits)
+
+static size_t sse2_count(const char* p, const char* end, char c)
+{
+    size_t n = 0;
+    __m128i needle = _mm_set1_epi8(c);
+
+    while (end - p >= 16)
+    {
+        n += SCANNER_POPCOUNT(unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), needle))));
+        p += 16;
+    }
+
+    return n + scalar_count(p, end, c);
+}
+
+SCANNER_AVX2_TARGET static __m256i avx2_in_range(__m256i c, char lo, char hi)
+{
+    __m256i shifted = _mm256_add_epi8(c, _mm256_set1_epi8(char(-128 - lo)));
+
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(char(-128 + (hi - lo) + 1)), shifted);
+}
+
+SCANNER_AVX2_TARGET static __m256i avx2_whitespace_mask(__m256i c)
+{
+    return _mm256_or_si256(_mm256_or_si256(
+        _mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')),
+        _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n'))),
+        _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\t')));
+}
+
+SCANNER_AVX2_TARGET static __m256i avx2_identifier_mask(__m256i c)
+{
+    __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+
+    return _mm256_or_si256(_mm256_or_si256(
+        avx2_in_range(lower, 'a', 'z'),
+        avx2_in_range(c, '0', '9')),
+        _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_')));
+}
+
+SCANNER_AVX2_TARGET static __m256i avx2_digit_mask(__m256i c)
+{
+    return avx2_in_range(c, '0', '9');
+}
+
+#define AVX2_SCANNER(name, mask_fn, tail_fn) \
+SCANNER_AVX2_TARGET static const char* name(const char* p, const char* end) \
+{ \
+    while (end - p >= 32) \
+    { \
+        unsigned stop = ~unsigned(_mm256_movemask_epi8(mask_fn(_mm256_loadu_si256((const __m256i*)p)))); \
+        if (stop) \
+        { \
+            return p + SCANNER_CTZ(stop); \
+        } \
+        p += 32; \
+    } \
+    return tail_fn(p, end); \
+}
+
+AVX2_SCANNER(avx2_whitespace, avx2_whitespace_mask, sse2_whitespace)
+AVX2_SCANNER(avx2_identifier, avx2_identifier_mask, sse2_identifier)
+AVX2_SCANNER(avx2_digits, avx2_digit_mask, sse2_digits)
+
+SCANNER_AVX2_TARGET static size_t avx2_count(const char* p, const char* end, char c)
+{
+    size_t n = 0;
+    __m256i needle = _mm256_set1_epi8(c);
+
+    while (end - p >= 32)
+    {
+        n += SCANNER_POPCOUNT(unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p), needle))));
+        p += 32;
+    }
+
+    return n + sse2_count(p, end, c);
+}
+
+static bool cpu_has_avx2()
+{
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("avx2");
+#else
+    int info[4];
+
+    __cpuid(info, 0);
+
+    if (info[0] < 7)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 1, 0);
+
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+
+    return (info[1] & (1 << 5)) != 0;
+#endif
+}
+
+#endif /* SCANNER_X86 */
+
+struct ScanFunctions
+{
+    const char* (*whitespace)(const char*, const char*);
+    const char* (*identifier)(const char*, const char*);
+    const char* (*digits)(const char*, const char*);
+    size_t (*count)(const char*, const char*, char);
+};
+
+static const ScanFunctions scan_functions[] =
+{
+    { scalar_whitespace, scalar_identifier, scalar_digits, scalar_count },
+#ifdef SCANNER_X86
+    { sse2_whitespace, sse2_identifier, sse2_digits, sse2_count },
+    { avx2_whitespace, avx2_identifier, avx2_digits, avx2_count },
+#endif
+};
+
+static ScanLevel detect_scan_level()
+{
+#ifdef SCANNER_X86
+    return cpu_has_avx2() ? SCAN_AVX2 : SCAN_SSE2;
+#else
+    return SCAN_SCALAR;
+#endif
+}
+
+static ScanLevel best_level = detect_scan_level();
+static const ScanFunctions* current = &scan_functions[best_level];
+
+const char* scan_whitespace(const char* begin, const char* end)
+{
+    return current->whitespace(begin, end);
+}
+
+const char* scan_identifier(const char* begin, const char* end)
+{
+    return current->identifier(begin, end);
+}
+
+const char* scan_digits(const char* begin, const char* end)
+{
+    return current->digits(begin, end);
+}
+
+size_t count_char(const char* begin, const char* end, char c)
+{
+    return current->count(begin, end, c);
+}
+
+ScanLevel best_scan_level()
+{
+    return best_level;
+}
+
+ScanLevel scan_level()
+{
+    return ScanLevel(current - scan_functions);
+}
+
+void set_scan_level(ScanLevel level)
+{
+    if (level > best_level)
+    {
+        level = best_level;
+    }
+
+    current = &scan_functions[level];
+}
@@ -0,0 +1,171 @@
+#include <SourceFile.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+SourceFile::SourceFile() : begin(""), length(0), opened(false)
+#ifdef _WIN32
+, file_handle(INVALID_HANDLE_VALUE), mapping_handle(0)
+#else
+, fd(-1)
+#endif
+{
+
+}
+
+SourceFile::SourceFile(const std::string& path) : begin(""), length(0), opened(false)
+#ifdef _WIN32
+, file_handle(INVALID_HANDLE_VALUE), mapping_handle(0)
+#else
+, fd(-1)
+#endif
+{
+    open(path);
+}
+
+SourceFile::~SourceFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+void SourceFile::open(const std::string& path)
+{
+    close();
+
+    file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+
+    if (file_handle == INVALID_HANDLE_VALUE)
+    {
+        throw SourceFileException("Can't open file \'" + path + "\'");
+    }
+
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx(file_handle, &file_size))
+    {
+        close();
+        throw SourceFileException("Can't get size of file \'" + path + "\'");
+    }
+
+    opened = true;
+
+    if (file_size.QuadPart == 0) // empty files can't be mapped
+    {
+        return;
+    }
+
+    mapping_handle = CreateFileMappingA(file_handle, 0, PAGE_READONLY, 0, 0, 0);
+
+    if (!mapping_handle)
+    {
+        close();
+        throw SourceFileException("Can't map file \'" + path + "\'");
+    }
+
+    const void* mapping = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+
+    if (!mapping)
+    {
+        close();
+        throw SourceFileException("Can't map file \'" + path + "\'");
+    }
+
+    begin = (const char*)mapping;
+    length = size_t(file_size.QuadPart);
+}
+
+void SourceFile::close()
+{
+    if (length != 0)
+    {
+        UnmapViewOfFile(begin);
+    }
+
+    if (mapping_handle)
+    {
+        CloseHandle(mapping_handle);
+    }
+
+    if (file_handle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(file_handle);
+    }
+
+    mapping_handle = 0;
+    file_handle = INVALID_HANDLE_VALUE;
+
+    begin = "";
+    length = 0;
+    opened = false;
+}
+
+#else
+
+void SourceFile::open(const std::string& path)
+{
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        throw SourceFileException("Can't open file \'" + path + "\'");
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0)
+    {
+        close();
+        throw SourceFileException("Can't get size of file \'" + path + "\'");
+    }
+
+    opened = true;
+
+    if (st.st_size == 0) // empty files can't be mapped
+    {
+        return;
+    }
+
+    void* mapping = mmap(0, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (mapping == MAP_FAILED)
+    {
+        close();
+        throw SourceFileException("Can't map file \'" + path + "\'");
+    }
+
+    madvise(mapping, size_t(st.st_size), MADV_SEQUENTIAL);
+
+    begin = (const char*)mapping;
+    length = size_t(st.st_size);
+}
+
+void SourceFile::close()
+{
+    if (length != 0)
+    {
+        munmap((void*)begin, length);
+    }
+
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+
+    fd = -1;
+
+    begin = "";
+    length = 0;
+    opened = false;
+}
+
+#endif
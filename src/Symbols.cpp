@@ -0,0 +1,100 @@
+#include <Symbols.h>
+
+#include <cstring>
+
+SymbolTable& SymbolTable::global()
+{
+    static SymbolTable table;
+
+    return table;
+}
+
+SymbolTable::SymbolTable() : slots(256, 0)
+{
+
+}
+
+int SymbolTable::intern(const char* s, size_t len)
+{
+    size_t h = hash(s, len);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t mask = slots.size() - 1;
+
+    for (size_t i = h & mask; ; i = (i + 1) & mask)
+    {
+        int id = slots[i] - 1;
+
+        if (id < 0)
+        {
+            id = int(names.size());
+
+            names.push_back(std::string(s, len));
+            hashes.push_back(h);
+
+            slots[i] = id + 1;
+
+            if (names.size() * 2 > slots.size())
+            {
+                grow();
+            }
+
+            return id;
+        }
+
+        if (hashes[id] == h && names[id].length() == len && memcmp(names[id].data(), s, len) == 0)
+        {
+            return id;
+        }
+    }
+}
+
+const std::string& SymbolTable::name(int id) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return names.at(id);
+}
+
+size_t SymbolTable::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return names.size();
+}
+
+size_t SymbolTable::hash(const char* s, size_t len)
+{
+    // FNV-1a
+    size_t h = 2166136261u;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+
+    return h;
+}
+
+void SymbolTable::grow()
+{
+    std::vector<int> new_slots(slots.size() * 2, 0);
+
+    size_t mask = new_slots.size() - 1;
+
+    for (size_t id = 0; id < names.size(); id++)
+    {
+        size_t i = hashes[id] & mask;
+
+        while (new_slots[i])
+        {
+            i = (i + 1) & mask;
+        }
+
+        new_slots[i] = int(id) + 1;
+    }
+
+    slots.swap(new_slots);
+}
@@ -0,0 +1,251 @@
+#include <VirtualMachine.h>
+
+// With GCC and Clang every handler ends in a jump of its own to the next
+// instruction's handler, through their labels-as-values extension, so the
+// branch predictor sees one branch per opcode. Elsewhere, or when the build
+// asks for it with INTERPRETER_SWITCH_DISPATCH, all handlers go back to a
+// single switch.
+#if defined(__GNUC__) && !defined(INTERPRETER_SWITCH_DISPATCH)
+#define VM_THREADED 1
+#define OPCODE(name) name
+#define DISPATCH() goto *handlers[i->op]
+#else
+#define OPCODE(name) case Instruction::name
+#define DISPATCH() goto dispatch
+#endif
+
+#define NEXT() do { i++; DISPATCH(); } while (0)
+#define JUMP(target) do { i = code + (target); DISPATCH(); } while (0)
+
+const char* VirtualMachine::dispatch()
+{
+#ifdef VM_THREADED
+    return "threaded";
+#else
+    return "switch";
+#endif
+}
+
+void VirtualMachine::run(const Program& program, Frame& frame)
+{
+    registers.assign(program.registers, Value());
+
+    for (uint32_t i = 0; i < program.variables; i++)
+    {
+        registers[i] = frame.get(i);
+    }
+
+    uint32_t first_constant = program.registers - uint32_t(program.constants.size());
+
+    for (size_t i = 0; i < program.constants.size(); i++)
+    {
+        Value& v = registers[first_constant + i];
+
+        v.tag = program.constant_types[i];
+        v.ival = program.constants[i];
+    }
+
+    out.clear();
+
+    try
+    {
+        execute(program);
+    }
+    catch (...)
+    {
+        store(program, frame);
+
+        throw;
+    }
+
+    store(program, frame);
+}
+
+void VirtualMachine::store(const Program& program, Frame& frame) const
+{
+    for (uint32_t i = 0; i < program.variables; i++)
+    {
+        if (registers[i].tag != Type::VOID)
+        {
+            frame.declare(int(i), program.names[i], registers[i]);
+        }
+    }
+}
+
+void VirtualMachine::execute(const Program& program)
+{
+    const Instruction* code = &program.code[0];
+    const Instruction* i = code;
+
+    Value* r = &registers[0];
+
+#ifdef VM_THREADED
+    // In the order of Instruction::Opcodes
+    static const void* const handlers[] =
+    {
+        &&MOVE,
+        &&I2F, &&F2I,
+
+        &&ADD_I, &&SUB_I, &&MUL_I,
+        &&ADD_F, &&SUB_F, &&MUL_F, &&DIV_F,
+        &&NONZERO_F,
+
+        &&DECLARE,
+        &&CHECK,
+
+        &&JUMP,
+        &&JLT_I, &&JLE_I, &&JEQ_I, &&JNE_I,
+        &&JLT_F, &&JLE_F, &&JEQ_F,
+        &&JNLT_F, &&JNLE_F, &&JNEQ_F,
+
+        &&PRINT_I, &&PRINT_F, &&PRINT_SPACE, &&PRINT_LINE,
+
+        &&FAIL,
+        &&HALT
+    };
+
+    static_assert(sizeof(handlers) / sizeof(handlers[0]) == Instruction::OPCODES_COUNT, "a handler is missing");
+
+    DISPATCH();
+#else
+dispatch:
+    switch (i->op)
+    {
+#endif
+    OPCODE(MOVE):
+        // Only the number, the tag of a variable is DECLARE's business
+        r[i->dst].ival = r[i->a].ival;
+        NEXT();
+    OPCODE(I2F):
+        r[i->dst].fval = float(r[i->a].ival);
+        NEXT();
+    OPCODE(F2I):
+        r[i->dst].ival = int(r[i->a].fval);
+        NEXT();
+    OPCODE(ADD_I):
+        r[i->dst].ival = int_add(r[i->a].ival, r[i->b].ival);
+        NEXT();
+    OPCODE(SUB_I):
+        r[i->dst].ival = int_subtract(r[i->a].ival, r[i->b].ival);
+        NEXT();
+    OPCODE(MUL_I):
+        r[i->dst].ival = int_multiply(r[i->a].ival, r[i->b].ival);
+        NEXT();
+    OPCODE(ADD_F):
+        r[i->dst].fval = r[i->a].fval + r[i->b].fval;
+        NEXT();
+    OPCODE(SUB_F):
+        r[i->dst].fval = r[i->a].fval - r[i->b].fval;
+        NEXT();
+    OPCODE(MUL_F):
+        r[i->dst].fval = r[i->a].fval * r[i->b].fval;
+        NEXT();
+    OPCODE(DIV_F):
+        if (r[i->b].fval == 0.f)
+        {
+            throw ZeroDivisionError();
+        }
+        r[i->dst].fval = r[i->a].fval / r[i->b].fval;
+        NEXT();
+    OPCODE(NONZERO_F):
+        if (r[i->a].fval == 0.f)
+        {
+            throw ZeroDivisionError();
+        }
+        NEXT();
+    OPCODE(DECLARE):
+        r[i->dst].tag = i->a;
+        NEXT();
+    OPCODE(CHECK):
+        if (r[i->dst].tag == Type::VOID)
+        {
+            Frame::undeclared(program.names[i->dst]);
+        }
+        NEXT();
+    OPCODE(JUMP):
+        JUMP(i->dst);
+    OPCODE(JLT_I):
+        if (r[i->a].ival < r[i->b].ival)
+        {
+            JUMP(i->dst);
+        }
+        NEXT();
+    OPCODE(JLE_I):
+        if (r[i->a].ival <= r[i->b].ival)
+        {
+            JUMP(i->dst);
+        }
+        NEXT();
+    OPCODE(JEQ_I):
+        if (r[i->a].ival == r[i->b].ival)
+        {
+            JUMP(i->dst);
+        }
+        NEXT();
+    OPCODE(JNE_I):
+        if (r[i->a].ival != r[i->b].ival)
+        {
+            JUMP(i->dst);
+        }
+        NEXT();
+    OPCODE(JLT_F):
+        if (r[i->a].fval < r[i->b].fval)
+        {
+            JUMP(i->dst);
+        }
+        NEXT();
+    OPCODE(JLE_F):
+        if (r[i->a].fval <= r[i->b].fval)
+        {
+            JUMP(i->dst);
+        }
+        NEXT();
+    OPCODE(JEQ_F):
+        if (r[i->a].fval == r[i->b].fval)
+        {
+            JUMP(i->dst);
+        }
+        NEXT();
+    OPCODE(JNLT_F):
+        if (!(r[i->a].fval < r[i->b].fval))
+        {
+            JUMP(i->dst);
+        }
+        NEXT();
+    OPCODE(JNLE_F):
+        if (!(r[i->a].fval <= r[i->b].fval))
+        {
+            JUMP(i->dst);
+        }
+        NEXT();
+    OPCODE(JNEQ_F):
+        if (!(r[i->a].fval == r[i->b].fval))
+        {
+            JUMP(i->dst);
+        }
+        NEXT();
+    OPCODE(PRINT_I):
+        // Integers print the way they did when every value was a float
+        out += std::to_string(r[i->a].ival);
+        out += ".000000 ";
+        NEXT();
+    OPCODE(PRINT_F):
+        out += std::to_string(r[i->a].fval);
+        out += ' ';
+        NEXT();
+    OPCODE(PRINT_SPACE):
+        out += ' ';
+        NEXT();
+    OPCODE(PRINT_LINE):
+        out += '\n';
+        std::cout << out;
+        out.clear();
+        NEXT();
+    OPCODE(FAIL):
+        throw InterpreterException(program.messages[i->a]);
+    OPCODE(HALT):
+        return;
+#ifndef VM_THREADED
+    }
+#endif
+}
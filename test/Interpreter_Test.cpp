@@ -1,15 +1,20 @@
 #include <gtest/gtest.h>
 #include <Interpreter.h>
+#include <Optimizer.h>
 
 TEST(INTERPRETER_TEST, BASIC_TEST1)
 {
+    AstArena ast;
+
     Interpreter i;
 
     SequenceNode sn;
-    sn.nodes = { std::shared_ptr<Node>(new DeclareVariableNode(FLOAT_TYPE, "a", std::shared_ptr<Node>(new SumNode(
-        std::shared_ptr<Node>(new FloatNumNode(2.f)),
-        std::shared_ptr<Node>(new FloatNumNode(2.f))
-    )))) };
+    sn.nodes = { ast.make<DeclareVariableNode>(FLOAT_TYPE, "a", ast.make<SumNode>(
+        ast.make<FloatNumNode>(2.f),
+        ast.make<FloatNumNode>(2.f)
+    )) };
+
+    Resolver().resolve(&sn);
 
     i.run(&sn);
 
@@ -18,17 +23,21 @@ TEST(INTERPRETER_TEST, BASIC_TEST1)
 
 TEST(INTERPRETER_TEST, BASIC_TEST2)
 {
+    AstArena ast;
+
     Interpreter i;
 
     SequenceNode sn;
-    sn.nodes = { std::shared_ptr<Node>(new DeclareVariableNode(FLOAT_TYPE, "a", std::shared_ptr<Node>(new SumNode(
-        std::shared_ptr<Node>(new FloatNumNode(2.f)),
-        std::shared_ptr<Node>(new FloatNumNode(2.f))
-    )))),
-    std::shared_ptr<Node>(new DeclareVariableNode(FLOAT_TYPE, "b", std::shared_ptr<Node>(new SumNode(
-        std::shared_ptr<Node>(new FloatNumNode(2.f)),
-        std::shared_ptr<Node>(new VariableNode("a", FLOAT_TYPE))
-    )))) };
+    sn.nodes = { ast.make<DeclareVariableNode>(FLOAT_TYPE, "a", ast.make<SumNode>(
+        ast.make<FloatNumNode>(2.f),
+        ast.make<FloatNumNode>(2.f)
+    )),
+    ast.make<DeclareVariableNode>(FLOAT_TYPE, "b", ast.make<SumNode>(
+        ast.make<FloatNumNode>(2.f),
+        ast.make<VariableNode>("a", FLOAT_TYPE)
+    )) };
+
+    Resolver().resolve(&sn);
 
     i.run(&sn);
 
@@ -38,12 +47,14 @@ TEST(INTERPRETER_TEST, BASIC_TEST2)
 
 TEST(INTERPRETER_TEST, BASIC_PRINT)
 {
+    AstArena ast;
+
     Interpreter i;
 
     SequenceNode sn;
-    sn.nodes = { std::shared_ptr<Node>(new PrintNode({
-        std::shared_ptr<Node>(new SumNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(2))))
-    })) };
+    sn.nodes = { ast.make<PrintNode>(std::vector<Node*>{
+        ast.make<SumNode>(ast.make<IntNumNode>(2), ast.make<IntNumNode>(2))
+    }) };
 
     testing::internal::CaptureStdout();
 
@@ -54,16 +65,18 @@ TEST(INTERPRETER_TEST, BASIC_PRINT)
 
 TEST(INTERPRETER_ASSIGN, BASIC_ASSIGN)
 {
+    AstArena ast;
+
     Interpreter i;
 
     SequenceNode sn;
-    sn.nodes = { std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(
-        new SumNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(2)))
-    ))),
-    std::shared_ptr<Node>(new AssignNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<Node>(new SumNode(
-        std::shared_ptr<Node>(new MultiplicationNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)))),
-        std::shared_ptr<Node>(new IntNumNode(2))
-    )))) };
+    sn.nodes = { ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<SumNode>(ast.make<IntNumNode>(2), ast.make<IntNumNode>(2))),
+    ast.make<AssignNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<SumNode>(
+        ast.make<MultiplicationNode>(ast.make<IntNumNode>(2), ast.make<VariableNode>("a", INTEGER_TYPE)),
+        ast.make<IntNumNode>(2)
+    )) };
+
+    Resolver().resolve(&sn);
 
     i.run(&sn);
 
@@ -72,14 +85,16 @@ TEST(INTERPRETER_ASSIGN, BASIC_ASSIGN)
 
 TEST(INTERPRETER_BRANCHING, BASIC_BRANCHING)
 {
+    AstArena ast;
+
     Interpreter i;
 
     SequenceNode sn;
-    sn.nodes = { std::shared_ptr<Node>(new BranchingNode(
-        std::shared_ptr<Node>(new LesserNode(std::shared_ptr<Node>(new SumNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(2)))),
-        std::shared_ptr<Node>(new IntNumNode(3)))),
-        std::shared_ptr<Node>(new PrintNode({ std::shared_ptr<Node>(new IntNumNode(1)) })),
-        std::shared_ptr<Node>(new PrintNode({ std::shared_ptr<Node>(new IntNumNode(0)) })))) }; // if (2 + 2 < 3) { print(1); } else { print(0); } -> should print '0'
+    sn.nodes = { ast.make<BranchingNode>(
+        ast.make<LesserNode>(ast.make<SumNode>(ast.make<IntNumNode>(2), ast.make<IntNumNode>(2)),
+        ast.make<IntNumNode>(3)),
+        ast.make<PrintNode>(std::vector<Node*>{ ast.make<IntNumNode>(1) }),
+        ast.make<PrintNode>(std::vector<Node*>{ ast.make<IntNumNode>(0) })) }; // if (2 + 2 < 3) { print(1); } else { print(0); } -> should print '0'
 
     testing::internal::CaptureStdout();
 
@@ -90,41 +105,570 @@ TEST(INTERPRETER_BRANCHING, BASIC_BRANCHING)
 
 TEST(INTERPRETER_CYCLING, BASIC_FOR_CYCLING)
 {
+    AstArena ast;
+
     Interpreter i;
 
-    std::shared_ptr<Node> n = std::shared_ptr<ForCycleNode>(new ForCycleNode(std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(new IntNumNode(0)))),
-    std::shared_ptr<Node>(new LesserNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<Node>(new IntNumNode(5)))),
-    std::shared_ptr<Node>(new AssignNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<SumNode>(
-        new SumNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<Node>(new IntNumNode(1)))
-    ))),
-    std::shared_ptr<Node>(new SequenceNode({ std::shared_ptr<Node>(new PrintNode({ std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)) })) }))));
+    Node* n = ast.make<ForCycleNode>(ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<IntNumNode>(0)),
+    ast.make<LesserNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<IntNumNode>(5)),
+    ast.make<AssignNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<SumNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<IntNumNode>(1))),
+    ast.make<SequenceNode>(std::vector<Node*>{ ast.make<PrintNode>(std::vector<Node*>{ ast.make<VariableNode>("a", INTEGER_TYPE) }) }));
+
+    Resolver().resolve(n);
 
     testing::internal::CaptureStdout();
 
-    i.run(n.get());
+    i.run(n);
 
     ASSERT_EQ(testing::internal::GetCapturedStdout(), std::string("0.000000 \n1.000000 \n2.000000 \n3.000000 \n4.000000 \n"));
 }
 
 TEST(INTERPRETER_CYCLING, BASIC_WHILE_CYCLING)
 {
+    AstArena ast;
+
     Interpreter i;
 
-    std::shared_ptr<Node> n = std::shared_ptr<SequenceNode>(new SequenceNode({
-        std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(new IntNumNode(0)))),
-        std::shared_ptr<WhileCycleNode>(new WhileCycleNode(
-        std::shared_ptr<Node>(new LesserNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<Node>(new IntNumNode(5)))),
-        std::shared_ptr<Node>(new SequenceNode({ 
-            std::shared_ptr<Node>(new AssignNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<SumNode>(
-            new SumNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<Node>(new IntNumNode(1)))
-        ))),
-        std::shared_ptr<Node>(new PrintNode({ std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)) })) 
-        }))))
-    })); // int a = 0; while (a < 5) { a = a + 1; print(a); };
+    Node* n = ast.make<SequenceNode>(std::vector<Node*>{
+        ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<IntNumNode>(0)),
+        ast.make<WhileCycleNode>(
+        ast.make<LesserNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<IntNumNode>(5)),
+        ast.make<SequenceNode>(std::vector<Node*>{ 
+            ast.make<AssignNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<SumNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<IntNumNode>(1))),
+        ast.make<PrintNode>(std::vector<Node*>{ ast.make<VariableNode>("a", INTEGER_TYPE) }) 
+        }))
+    }); // int a = 0; while (a < 5) { a = a + 1; print(a); };
+
+    Resolver().resolve(n);
 
     testing::internal::CaptureStdout();
 
-    i.run(n.get());
+    i.run(n);
 
     ASSERT_EQ(testing::internal::GetCapturedStdout(), std::string("1.000000 \n2.000000 \n3.000000 \n4.000000 \n5.000000 \n"));
-}
\ No newline at end of file
+}
+
+TEST(INTERPRETER_FLAT_AST, SAME_OUTPUT)
+{
+    Lexer l;
+    Parser p(l.make_tokens("int a = 0; float b = 0.5;\nfor (int i = 0; i < 4; i = i + 1) { a = a + i * 3 / 2; print(a, b); };\n"
+        "while (b < 3.) { b = b * 2.; if (b > 1.) { print(b); } else { print(a); }; };"));
+
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Interpreter tree_interpreter;
+
+    testing::internal::CaptureStdout();
+    tree_interpreter.run(sn.get());
+    std::string expected = testing::internal::GetCapturedStdout();
+
+    Interpreter flat_interpreter;
+
+    testing::internal::CaptureStdout();
+    flat_interpreter.run(FlatAst(sn.get()));
+
+    ASSERT_EQ(testing::internal::GetCapturedStdout(), expected);
+    ASSERT_EQ(flat_interpreter.get_var("a").ival, tree_interpreter.get_var("a").ival);
+    ASSERT_FLOAT_EQ(flat_interpreter.get_var("b").fval, 4.f);
+}
+
+TEST(INTERPRETER_TEST, USE_BEFORE_DECLARATION)
+{
+    Lexer l;
+
+    // Declarations are visible to the parser even when they never run
+    Parser p(l.make_tokens("int a = 1;\nif (a > 1) { int b = 2; } else { a = 2; };\na = b;"));
+
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Interpreter i;
+
+    ASSERT_THROW(i.run(sn.get()), InterpreterException);
+    ASSERT_EQ(i.get_var("a").ival, 2);
+}
+
+TEST(INTERPRETER_TEST, UNDECLARED_LOWER_SLOT)
+{
+    Lexer l;
+
+    // b gets its slot before c, but only the declaration of c runs
+    Parser p(l.make_tokens("int a = 1;\nif (a > 1) { int b = 2; } else { int c = 3; };\na = b;"));
+
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Interpreter i;
+
+    ASSERT_THROW(i.run(sn.get()), InterpreterException);
+    ASSERT_EQ(i.get_var("c").ival, 3);
+    ASSERT_THROW(i.get_var("b"), InterpreterException);
+}
+
+TEST(INTERPRETER_TEST, BLOCK_DECLARATIONS)
+{
+    Lexer l;
+
+    // The body declares t again on every iteration, and t is still there
+    // once the loop is done
+    Parser p(l.make_tokens("int s = 0;\nfor (int i = 0; i < 1000; i = i + 1) { int t = i * 2; s = s + t; };\nprint(s, t);"));
+
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Interpreter i;
+    i.run(sn.get());
+
+    ASSERT_EQ(i.get_var("s").ival, 999000);
+    ASSERT_EQ(i.get_var("t").ival, 1998);
+    ASSERT_EQ(i.get_var("i").ival, 1000);
+}
+
+TEST(INTERPRETER_TEST, INTEGER_ARITHMETIC)
+{
+    Lexer l;
+
+    // 2^24 + 1 has no float of its own, / still gives a float
+    Parser p(l.make_tokens("int a = 16777216 + 1;\nint b = a * 2 - 1;\nint c = 7 / 2 * 2;\nfloat f = 7 / 2;\nint d = 0;\nif (a > 16777216) { d = 1; } else { d = 2; };\nint w = 2147483647 + a - 16777217;\nint m = a * 256;"));
+
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+    FlatAst flat(sn.get());
+
+    Interpreter tree_interpreter;
+    tree_interpreter.run(sn.get());
+
+    Interpreter flat_interpreter;
+    flat_interpreter.run(flat);
+
+    const Interpreter* interpreters[] = { &tree_interpreter, &flat_interpreter };
+
+    for (int i = 0; i < 2; i++)
+    {
+        ASSERT_EQ(interpreters[i]->get_var("a").ival, 16777217);
+        ASSERT_EQ(interpreters[i]->get_var("b").ival, 33554433);
+        ASSERT_EQ(interpreters[i]->get_var("c").ival, 7);
+        ASSERT_FLOAT_EQ(interpreters[i]->get_var("f").fval, 3.5f);
+        ASSERT_EQ(interpreters[i]->get_var("d").ival, 1);
+
+        // Overflow wraps around
+        ASSERT_EQ(interpreters[i]->get_var("w").ival, 2147483647);
+        ASSERT_EQ(interpreters[i]->get_var("m").ival, 256);
+    }
+}
+
+TEST(INTERPRETER_TEST, QUICKENING)
+{
+    Lexer l;
+
+    Parser p(l.make_tokens("int n = 5; int s = 0;\nfor (int i = 0; i < n; i = i + 1) { s = s + 2; };"));
+
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Interpreter i;
+    i.run(sn.get());
+
+    ASSERT_EQ(i.get_var("s").ival, 10);
+    ASSERT_EQ(i.get_var("i").ival, 5);
+
+    const ForCycleNode* fcn = static_cast<const ForCycleNode*>(sn->nodes[2]);
+    const AssignNode* add = static_cast<const AssignNode*>(static_cast<const SequenceNode*>(fcn->body)->nodes[0]);
+
+    ASSERT_EQ(fcn->condition->runs_as, Node::INT_LESSER);
+    ASSERT_EQ(fcn->step->runs_as, Node::INCREMENT);
+    ASSERT_EQ(add->runs_as, Node::INCREMENT);
+
+    // The other engines still see the nodes as they were built
+    Interpreter bytecode(Interpreter::BYTECODE);
+    bytecode.run(sn.get());
+
+    ASSERT_EQ(bytecode.get_var("s").ival, 10);
+}
+
+TEST(INTERPRETER_TEST, QUICKENING_FALLBACK)
+{
+    AstArena ast;
+
+    // t is read as an integer from a slot holding a float, which the
+    // INT_LESSER form doesn't take
+    SequenceNode sn;
+    sn.nodes = { ast.make<DeclareVariableNode>(FLOAT_TYPE, "t", ast.make<FloatNumNode>(2.5f)),
+        ast.make<DeclareVariableNode>(INTEGER_TYPE, "r", ast.make<IntNumNode>(0)),
+        ast.make<BranchingNode>(ast.make<LesserNode>(ast.make<VariableNode>("t", INTEGER_TYPE), ast.make<IntNumNode>(5)),
+            ast.make<AssignNode>(ast.make<VariableNode>("r", INTEGER_TYPE), ast.make<IntNumNode>(1)),
+            ast.make<AssignNode>(ast.make<VariableNode>("r", INTEGER_TYPE), ast.make<IntNumNode>(2))) };
+
+    Resolver().resolve(&sn);
+
+    Interpreter i;
+    i.run(&sn);
+
+    const Node* condition = static_cast<const BranchingNode*>(sn.nodes[2])->statement;
+
+    // Back to the generic comparison, which reads the float's bits as ints
+    // always have
+    ASSERT_TRUE(condition->quickened);
+    ASSERT_EQ(condition->runs_as, Node::LESSER);
+    ASSERT_EQ(i.get_var("r").ival, 2);
+}
+
+TEST(INTERPRETER_OPTIMIZER, FOLDING)
+{
+    Lexer l;
+
+    std::string code = "int a = 2 * 3 + 4;\nfloat b = 1. / 4 + 2;\nint n = a * 1 + 0;\nint z = n * 0;\nfloat h = n / 4;\nprint(2 * 3 + 4, h, 7 / 2);";
+
+    Parser p(l.make_tokens(code));
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Optimizer o(*p.get_arena());
+    ASSERT_EQ(o.optimize(sn.get()), sn.get());
+
+    const Node* expressions[5];
+
+    for (int i = 0; i < 5; i++)
+    {
+        expressions[i] = static_cast<const DeclareVariableNode*>(sn->nodes[i])->expression;
+    }
+
+    ASSERT_EQ(expressions[0]->type, Node::INTEGER);
+    ASSERT_EQ(static_cast<const IntNumNode*>(expressions[0])->val, 10);
+    ASSERT_EQ(expressions[1]->type, Node::FLOAT);
+    ASSERT_FLOAT_EQ(static_cast<const FloatNumNode*>(expressions[1])->val, 2.25f);
+    ASSERT_EQ(expressions[2]->type, Node::VAR);
+    ASSERT_EQ(expressions[3]->type, Node::INTEGER);
+    ASSERT_EQ(expressions[4]->type, Node::MULTIPLICATION);
+    ASSERT_EQ(expressions[4]->valtype, Type::FLOAT);
+
+    // The same as without the pass, on every engine
+    Parser plain(l.make_tokens(code));
+    std::shared_ptr<SequenceNode> plain_tree = plain.make_tree();
+
+    Interpreter expected;
+
+    testing::internal::CaptureStdout();
+    expected.run(plain_tree.get());
+    std::string expected_output = testing::internal::GetCapturedStdout();
+
+    ASSERT_EQ(expected_output, "10.000000 2.500000 3.500000 \n");
+
+    Interpreter::Engine engines[] = { Interpreter::TREE_WALKER, Interpreter::BYTECODE, Interpreter::CLOSURES };
+
+    for (int i = 0; i < 3; i++)
+    {
+        Interpreter optimized(engines[i]);
+
+        testing::internal::CaptureStdout();
+        optimized.run(sn.get());
+        ASSERT_EQ(testing::internal::GetCapturedStdout(), expected_output);
+
+        ASSERT_EQ(optimized.get_var("a").ival, expected.get_var("a").ival);
+        ASSERT_EQ(optimized.get_var("n").ival, expected.get_var("n").ival);
+        ASSERT_EQ(optimized.get_var("z").ival, expected.get_var("z").ival);
+        ASSERT_FLOAT_EQ(optimized.get_var("b").fval, expected.get_var("b").fval);
+        ASSERT_FLOAT_EQ(optimized.get_var("h").fval, expected.get_var("h").fval);
+    }
+}
+
+TEST(INTERPRETER_OPTIMIZER, KEEPS_SEMANTICS)
+{
+    Lexer l;
+
+    // m is -0., and -0. + 0 is 0.; b may not be declared when b * 0 runs; 1 / 3
+    // has no exact reciprocal
+    Parser p(l.make_tokens("float m = 0. * (0. - 1.);\nfloat s = m + 0;\nfloat t = m / 3;\nif (m > 1.) { int b = 2; } else { m = m; };\nint z = b * 0;"));
+
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Optimizer(*p.get_arena()).optimize(sn.get());
+
+    ASSERT_EQ(static_cast<const DeclareVariableNode*>(sn->nodes[1])->expression->type, Node::SUM);
+    ASSERT_EQ(static_cast<const DeclareVariableNode*>(sn->nodes[2])->expression->type, Node::DIVISION);
+    ASSERT_EQ(static_cast<const DeclareVariableNode*>(sn->nodes[4])->expression->type, Node::MULTIPLICATION);
+
+    Interpreter i;
+
+    ASSERT_THROW(i.run(sn.get()), InterpreterException);
+    ASSERT_FALSE(std::signbit(i.get_var("s").fval));
+
+    // A division by 0 stays to throw
+    Parser zero(l.make_tokens("float x = 1. / (2 - 2);"));
+
+    std::shared_ptr<SequenceNode> zero_tree = zero.make_tree();
+
+    Optimizer(*zero.get_arena()).optimize(zero_tree.get());
+
+    ASSERT_THROW(Interpreter().run(zero_tree.get()), ZeroDivisionError);
+
+    // x - -0. turns x = -0. into 0.
+    Parser negative_zero(l.make_tokens("float x = (0. - 1.) * 0.;\nprint(x - (0. - 1.) * 0.);"));
+
+    std::shared_ptr<SequenceNode> negative_zero_tree = negative_zero.make_tree();
+
+    Optimizer(*negative_zero.get_arena()).optimize(negative_zero_tree.get());
+
+    ASSERT_EQ(static_cast<const PrintNode*>(negative_zero_tree->nodes[1])->expressions[0]->type, Node::SUBTRACT);
+
+    Interpreter::Engine engines[] = { Interpreter::TREE_WALKER, Interpreter::BYTECODE, Interpreter::CLOSURES };
+
+    for (int j = 0; j < 3; j++)
+    {
+        testing::internal::CaptureStdout();
+        Interpreter(engines[j]).run(negative_zero_tree.get());
+        ASSERT_EQ(testing::internal::GetCapturedStdout(), "0.000000 \n");
+    }
+}
+
+TEST(INTERPRETER_OPTIMIZER, DEAD_BRANCHES)
+{
+    Lexer l;
+
+    std::string code =
+        "int a = 0;\n"
+        "if (1 < 2) { a = 1; } else { a = 2; };\n"
+        "if ((2 > 3) && (a < 5)) { a = 3; } else { a = a + 10; };\n"
+        "if (a > 5) { a = a * 2; } else { };\n"
+        "while (1. > 2) { a = 0; };\n"
+        "for (int i = 0; 3 < 1; i = i + 1) { a = 0; };\n"
+        "int n = 0;\n"
+        "while ((1 < 2) || (n < 1)) { n = n + 1; if (n > 3) { float q = 1. / (n - n); } else { }; };\n"
+        "print(a);";
+
+    Parser p(l.make_tokens(code));
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Optimizer(*p.get_arena()).optimize(sn.get());
+
+    int types[] = { Node::DECLVAR, Node::ASSIGN, Node::ASSIGN, Node::BRANCHING, Node::DECLVAR, Node::DECLVAR, Node::WHILECYCLE };
+
+    ASSERT_EQ(sn->nodes.size(), 7);
+
+    for (int i = 0; i < 7; i++)
+    {
+        ASSERT_EQ(sn->nodes[i]->type, types[i]);
+    }
+
+    ASSERT_EQ(static_cast<const BranchingNode*>(sn->nodes[3])->else_body, nullptr);
+
+    const SequenceNode* loop_body = static_cast<const SequenceNode*>(static_cast<const WhileCycleNode*>(sn->nodes[6])->body);
+
+    ASSERT_EQ(static_cast<const BranchingNode*>(loop_body->nodes[1])->else_body, nullptr);
+
+    // The endless loop ends with the division by 0, print() never ran
+    Parser plain(l.make_tokens(code));
+    std::shared_ptr<SequenceNode> plain_tree = plain.make_tree();
+
+    const Node* trees[] = { plain_tree.get(), sn.get() };
+
+    for (int i = 0; i < 2; i++)
+    {
+        Interpreter interpreter;
+
+        testing::internal::CaptureStdout();
+        ASSERT_THROW(interpreter.run(trees[i]), ZeroDivisionError);
+        ASSERT_EQ(testing::internal::GetCapturedStdout(), "");
+
+        ASSERT_EQ(interpreter.get_var("a").ival, 22);
+        ASSERT_EQ(interpreter.get_var("i").ival, 0);
+        ASSERT_EQ(interpreter.get_var("n").ival, 4);
+    }
+
+    // A number as an operand of || throws before the comparison next to it
+    // is looked at, so these branches stay
+    std::string bad_code[] = {
+        "if (1 || (1 < 2)) { print(1); } else { };",
+        "int b = 1; if (b || (1 < 2)) { print(1); } else { };",
+        "while (1 || (1 < 2)) { print(1); }; print(2);"
+    };
+
+    for (int i = 0; i < 3; i++)
+    {
+        Parser bad(l.make_tokens(bad_code[i]));
+        std::shared_ptr<SequenceNode> bad_tree = bad.make_tree();
+
+        Parser bad_plain(l.make_tokens(bad_code[i]));
+        std::shared_ptr<SequenceNode> bad_plain_tree = bad_plain.make_tree();
+
+        Optimizer(*bad.get_arena()).optimize(bad_tree.get());
+
+        const Node* bad_trees[] = { bad_plain_tree.get(), bad_tree.get() };
+
+        for (int j = 0; j < 2; j++)
+        {
+            Interpreter interpreter;
+
+            testing::internal::CaptureStdout();
+            ASSERT_THROW(interpreter.run(bad_trees[j]), InterpreterException);
+            ASSERT_EQ(testing::internal::GetCapturedStdout(), "");
+        }
+    }
+}
+
+TEST(INTERPRETER_BYTECODE, SAME_OUTPUT)
+{
+    Lexer l;
+
+    Parser p(l.make_tokens(
+        "int a = 3; float b = 0.5; int n = 0;\n"
+        "while (n < 10) { n = n + 1; if ((n > 4) && (a < 100) || (b == 2.)) { a = a * 2 - n; } else { b = b + a / 4; }; print(a, b, n * 2); };\n"
+        "for (int i = 0; i < 3; i = i + 1) { float f = i / 2; print(f, b - f); };\n"
+        "int c = b * 3;"));
+
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Interpreter tree_interpreter;
+
+    testing::internal::CaptureStdout();
+    tree_interpreter.run(sn.get());
+    std::string tree_output = testing::internal::GetCapturedStdout();
+
+    Interpreter bytecode_interpreter(Interpreter::BYTECODE);
+
+    testing::internal::CaptureStdout();
+    bytecode_interpreter.run(sn.get());
+    std::string bytecode_output = testing::internal::GetCapturedStdout();
+
+    ASSERT_EQ(bytecode_output, tree_output);
+
+    const char* names[] = { "a", "n", "i", "c" };
+
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(bytecode_interpreter.get_var(names[i]).ival, tree_interpreter.get_var(names[i]).ival);
+    }
+
+    ASSERT_FLOAT_EQ(bytecode_interpreter.get_var("b").fval, tree_interpreter.get_var("b").fval);
+    ASSERT_FLOAT_EQ(bytecode_interpreter.get_var("f").fval, tree_interpreter.get_var("f").fval);
+}
+
+TEST(INTERPRETER_BYTECODE, ERRORS)
+{
+    Lexer l;
+
+    Parser p(l.make_tokens("int a = 1;\nif (a > 1) { int b = 2; } else { a = 2; };\nprint(a);\na = b;"));
+
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Interpreter i(Interpreter::BYTECODE);
+
+    testing::internal::CaptureStdout();
+    ASSERT_THROW(i.run(sn.get()), InterpreterException);
+    ASSERT_EQ(testing::internal::GetCapturedStdout(), "2.000000 \n");
+
+    // Variables declared before the error are kept
+    ASSERT_EQ(i.get_var("a").ival, 2);
+    ASSERT_THROW(i.get_var("b"), InterpreterException);
+
+    Parser zero(l.make_tokens("float x = 1.; x = x / (x - 1.);"));
+
+    std::shared_ptr<SequenceNode> zero_tree = zero.make_tree();
+
+    ASSERT_THROW(Interpreter(Interpreter::BYTECODE).run(zero_tree.get()), ZeroDivisionError);
+}
+
+TEST(INTERPRETER_CLOSURES, SAME_OUTPUT)
+{
+    Lexer l;
+
+    Parser p(l.make_tokens(
+        "int a = 3; float b = 0.5; int n = 0;\n"
+        "while (n < 10) { n = n + 1; if ((n > 4) && (a < 100) || (b == 2.)) { a = a * 2 - n; } else { b = b + a / 4; }; print(a, b, n * 2); };\n"
+        "for (int i = 0; i < 3; i = i + 1) { float f = i / 2; print(f, b - f, 7 - i); };\n"
+        "int c = b * 3; if (c >= 3 * c) { c = 0; } else { c = c + 1; };"));
+
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Interpreter tree_interpreter;
+
+    testing::internal::CaptureStdout();
+    tree_interpreter.run(sn.get());
+    std::string tree_output = testing::internal::GetCapturedStdout();
+
+    Interpreter closure_interpreter(Interpreter::CLOSURES);
+
+    testing::internal::CaptureStdout();
+    closure_interpreter.run(sn.get());
+    std::string closure_output = testing::internal::GetCapturedStdout();
+
+    ASSERT_EQ(closure_output, tree_output);
+
+    const char* names[] = { "a", "n", "i", "c" };
+
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(closure_interpreter.get_var(names[i]).ival, tree_interpreter.get_var(names[i]).ival);
+    }
+
+    ASSERT_FLOAT_EQ(closure_interpreter.get_var("b").fval, tree_interpreter.get_var("b").fval);
+    ASSERT_FLOAT_EQ(closure_interpreter.get_var("f").fval, tree_interpreter.get_var("f").fval);
+}
+
+TEST(INTERPRETER_CLOSURES, ERRORS)
+{
+    Lexer l;
+
+    Parser p(l.make_tokens("int a = 1;\nif (a > 1) { int b = 2; } else { a = 2; };\nprint(a);\na = b;"));
+
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Interpreter i(Interpreter::CLOSURES);
+
+    testing::internal::CaptureStdout();
+    ASSERT_THROW(i.run(sn.get()), InterpreterException);
+    ASSERT_EQ(testing::internal::GetCapturedStdout(), "2.000000 \n");
+
+    ASSERT_EQ(i.get_var("a").ival, 2);
+    ASSERT_THROW(i.get_var("b"), InterpreterException);
+
+    Parser zero(l.make_tokens("float x = 1.; x = x / (x - 1.);"));
+
+    std::shared_ptr<SequenceNode> zero_tree = zero.make_tree();
+
+    ASSERT_THROW(Interpreter(Interpreter::CLOSURES).run(zero_tree.get()), ZeroDivisionError);
+}
+
+TEST(INTERPRETER_ENGINES, ERROR_ORDER)
+{
+    Lexer l;
+
+    // Nothing the loop declares exists after it, and every engine reports
+    // the left operand of the first operation that reaches one
+    std::string loop = "int x = 1; while (x < 1) { int a = 1; int b = 2; float f = 1.; float g = 2.; };\n";
+
+    std::string statements[] = { "print(a + b);", "print(b - a);", "print(f * g);", "if (a < b) { print(1); } else { };", "if (g >= f) { print(1); } else { };" };
+    std::string names[] = { "a", "b", "f", "a", "g" };
+
+    Interpreter::Engine engines[] = { Interpreter::TREE_WALKER, Interpreter::BYTECODE, Interpreter::CLOSURES };
+
+    for (int i = 0; i < 5; i++)
+    {
+        Parser p(l.make_tokens(loop + statements[i]));
+        std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+        std::string expected;
+
+        for (int j = 0; j < 4; j++)
+        {
+            try
+            {
+                if (j < 3)
+                {
+                    Interpreter(engines[j]).run(sn.get());
+                }
+                else
+                {
+                    Interpreter().run(FlatAst(sn.get()));
+                }
+
+                FAIL() << statements[i] << " ran";
+            }
+            catch (const InterpreterException& e)
+            {
+                if (j == 0)
+                {
+                    expected = e.what();
+                }
+
+                ASSERT_EQ(e.what(), expected) << statements[i] << " on engine " << j;
+            }
+        }
+
+        ASSERT_NE(expected.find("'" + names[i] + "'"), std::string::npos) << expected;
+    }
+}
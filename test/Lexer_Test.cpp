@@ -1,4 +1,8 @@
 #include <Lexer.h>
+#include <Scanner.h>
+
+#include <sstream>
+#include <cstdlib>
 #include <gtest/gtest.h>
 
 #define LEXER_TESTING_MACRO ASSERT_EQ(result.size(),expected.size());\
@@ -193,4 +197,344 @@ TEST(LEXER_PRINT, PRINT)
     std::vector<Token> expected = { PRINT_T, LPARENTHESIS_T, IntegerToken(2), PLUS_T, IntegerToken(2), RPARENTHESIS_T, SEMICOLON_T };
 
     LEXER_TESTING_MACRO
-}
\ No newline at end of file
+}
+
+TEST(LEXER_SOURCE_FILE, MAPPED_FILE)
+{
+    const char* path = "lexer_source_file_test.txt";
+
+    FILE* f = fopen(path, "wb");
+    ASSERT_TRUE(f != 0);
+    fputs("print(2 + 2);", f);
+    fclose(f);
+
+    std::vector<Token> result;
+
+    {
+        SourceFile file(path);
+        Lexer l;
+
+        ASSERT_EQ(file.size(), 13);
+
+        result = l.make_tokens(file);
+    }
+
+    remove(path);
+
+    std::vector<Token> expected = { PRINT_T, LPARENTHESIS_T, IntegerToken(2), PLUS_T, IntegerToken(2), RPARENTHESIS_T, SEMICOLON_T };
+
+    LEXER_TESTING_MACRO
+
+    ASSERT_THROW(SourceFile("no_such_file.txt"), SourceFileException);
+}
+
+TEST(LEXER_SYMBOLS, INTERNED_NAMES)
+{
+    Lexer l;
+
+    std::vector<Token> result = l.make_tokens("abc abd abc x_1");
+
+    ASSERT_EQ(result.size(), 4);
+    ASSERT_EQ(result[0].sym, result[2].sym);
+    ASSERT_NE(result[0].sym, result[1].sym);
+    ASSERT_EQ(result[3].name(), std::string("x_1"));
+    ASSERT_EQ(result[0].sym, Token("abc").sym);
+
+    int before = SymbolTable::global().size();
+
+    for (int i = 0; i < 1000; i++)
+    {
+        SymbolTable::global().intern("symbol_" + std::to_string(i));
+    }
+
+    ASSERT_EQ(SymbolTable::global().size(), before + 1000);
+    ASSERT_EQ(SymbolTable::global().name(SymbolTable::global().intern("symbol_500")), std::string("symbol_500"));
+    ASSERT_EQ(SymbolTable::global().size(), before + 1000);
+}
+
+TEST(LEXER_KEYWORDS, KEYWORDS)
+{
+    Lexer l;
+
+    std::vector<Token> result = l.make_tokens("int float print if else for while intx floats whilee if_ fo");
+    std::vector<Token> expected = { Token(Token::INTTYPE), Token(Token::FLOATTYPE), PRINT_T, IF_T, ELSE_T, FOR_T, WHILE_T,
+    Token("intx"), Token("floats"), Token("whilee"), Token("if_"), Token("fo") };
+
+    LEXER_TESTING_MACRO
+}
+
+TEST(LEXER_SCANNER, SCAN_LEVELS)
+{
+    std::string code;
+
+    for (int i = 0; i < 200; i++)
+    {
+        code += "int variable_" + std::to_string(i) + " = " + std::to_string(i * 7919) + " * 3.25;\n\t  ";
+        code += std::string(i % 40, ' ') + "print(variable_" + std::to_string(i) + ");";
+    }
+
+    ScanLevel best = best_scan_level();
+
+    Lexer l;
+
+    set_scan_level(SCAN_SCALAR);
+    std::vector<Token> expected = l.make_tokens(code);
+
+    for (int level = SCAN_SCALAR; level <= best; level++)
+    {
+        set_scan_level(ScanLevel(level));
+        ASSERT_EQ(scan_level(), level);
+
+        std::vector<Token> result = l.make_tokens(code);
+
+        LEXER_TESTING_MACRO
+
+        for (size_t len = 0; len < 70; len++)
+        {
+            std::string s = std::string(len, 'a') + "+" + std::string(len, ' ') + "-" + std::string(len, '7') + "!\n";
+            const char* p = s.data();
+            const char* end = p + s.length();
+
+            ASSERT_EQ(scan_identifier(p, end), p + len);
+            ASSERT_EQ(scan_whitespace(p + len + 1, end), p + 2 * len + 1);
+            ASSERT_EQ(scan_digits(p + 2 * len + 2, end), p + 3 * len + 2);
+            ASSERT_EQ(count_char(p, end, 'a'), len);
+        }
+    }
+
+    set_scan_level(best);
+}
+
+TEST(LEXER_POSITIONS, OFFSETS)
+{
+    Lexer l;
+
+    std::string code = "int a;\n  while (a >= 10)\n\nprint(a);";
+    std::vector<Token> result = l.make_tokens(code);
+
+    ASSERT_EQ(result.size(), 14);
+    ASSERT_EQ(result[0].offset, 0);  // int
+    ASSERT_EQ(result[1].offset, 4);  // a
+    ASSERT_EQ(result[3].offset, 9);  // while
+    ASSERT_EQ(result[6].offset, 18); // >=
+    ASSERT_EQ(result[9].offset, 26); // print
+
+    LineIndex& lines = l.line_index();
+
+    SourcePosition pos = lines.locate(result[3].offset);
+    ASSERT_EQ(pos.line, 2);
+    ASSERT_EQ(pos.column, 3);
+
+    pos = lines.locate(result[9].offset);
+    ASSERT_EQ(pos.line, 4);
+    ASSERT_EQ(pos.column, 1);
+
+    pos = lines.locate(result[0].offset);
+    ASSERT_EQ(pos.line, 1);
+    ASSERT_EQ(pos.column, 1);
+}
+
+TEST(LEXER_STREAM, STREAM_INPUT)
+{
+    std::string code;
+
+    for (int i = 0; code.size() < 300 * 1024; i++)
+    {
+        code += "if (value_" + std::to_string(i) + " == " + std::to_string(i) + ".5) {\n print(" + std::to_string(i) + ");}; ";
+    }
+
+    Lexer l;
+
+    std::vector<Token> expected = l.make_tokens(code);
+
+    std::istringstream input(code);
+
+    l.begin(input);
+
+    std::vector<Token> result;
+    Token t;
+
+    while (l.next_token(t))
+    {
+        result.push_back(t);
+    }
+
+    LEXER_TESTING_MACRO
+
+    for (int i = 0; i < expected.size(); i++)
+    {
+        ASSERT_EQ(result[i].offset, expected[i].offset);
+    }
+
+    LineIndex whole(code.data(), code.size());
+
+    SourcePosition pos = l.line_index().locate(result.back().offset);
+    SourcePosition expected_pos = whole.locate(result.back().offset);
+
+    ASSERT_EQ(pos.line, expected_pos.line);
+    ASSERT_EQ(pos.column, expected_pos.column);
+}
+
+TEST(LEXER_STREAM, TOKEN_ACROSS_CHUNKS)
+{
+    // The stream is read 64 KiB at a time, so these tokens start in the last
+    // byte of the first chunk and end in the second one
+    const char* tokens[] = { ".5", "1.", "==" };
+
+    for (int i = 0; i < 3; i++)
+    {
+        std::string code = "float b = 1.;" + std::string(64 * 1024 - 14, ' ') + tokens[i] + " ;";
+
+        Lexer l;
+
+        std::vector<Token> expected = l.make_tokens(code);
+
+        std::istringstream input(code);
+
+        l.begin(input);
+
+        std::vector<Token> result;
+        Token t;
+
+        while (l.next_token(t))
+        {
+            result.push_back(t);
+        }
+
+        LEXER_TESTING_MACRO
+
+        for (int j = 0; j < expected.size(); j++)
+        {
+            ASSERT_EQ(result[j].offset, expected[j].offset);
+        }
+    }
+
+    // A broken literal that nothing follows still fails
+    std::istringstream input(std::string(64 * 1024 - 1, ' ') + ".");
+
+    Lexer l;
+    l.begin(input);
+
+    Token t;
+
+    ASSERT_THROW(while (l.next_token(t)) {}, InvalidNumberError);
+}
+
+TEST(LEXER_TOKEN_BUFFER, TOKEN_BUFFER)
+{
+    Lexer l;
+
+    std::string code = "float x = 2.5 * y1; print(x, 7);";
+
+    std::vector<Token> expected = l.make_tokens(code);
+
+    TokenBuffer buffer;
+    l.make_tokens(code.data(), code.size(), buffer);
+
+    ASSERT_EQ(buffer.size(), expected.size());
+
+    for (int i = 0; i < expected.size(); i++)
+    {
+        ASSERT_EQ(buffer.type(i), expected[i].type);
+        ASSERT_EQ(buffer.offset(i), expected[i].offset);
+        ASSERT_TRUE(buffer.at(i).is_same(expected[i]));
+    }
+}
+
+TEST(LEXER_PARALLEL, PARALLEL_TOKENS)
+{
+    std::string code;
+
+    for (int i = 0; code.size() < 2 * 1024 * 1024; i++)
+    {
+        code += "int name_" + std::to_string(i % 5000) + " = " + std::to_string(i) + " * 1.5;\n\t";
+        code += "if (name_" + std::to_string(i % 77) + " >= 3) { print(shared_name); };";
+    }
+
+    Lexer l;
+
+    TokenBuffer expected;
+    l.make_tokens(code.data(), code.size(), expected);
+
+    TokenBuffer result;
+    l.make_tokens_parallel(code.data(), code.size(), result, 4);
+
+    ASSERT_EQ(result.size(), expected.size());
+
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        ASSERT_EQ(result.type(i), expected.type(i));
+        ASSERT_EQ(result.offset(i), expected.offset(i));
+        ASSERT_TRUE(result.at(i).is_same(expected.at(i)));
+    }
+
+    SourcePosition pos = l.line_index().locate(result.offset(result.size() - 1));
+    SourcePosition expected_pos = LineIndex(code.data(), code.size()).locate(result.offset(result.size() - 1));
+
+    ASSERT_EQ(pos.line, expected_pos.line);
+    ASSERT_EQ(pos.column, expected_pos.column);
+}
+
+TEST(LEXER_LITERALS, INTEGER_LIMITS)
+{
+    Lexer l;
+
+    std::vector<Token> result = l.make_tokens("2147483647 0000000000002147483647 0");
+
+    ASSERT_EQ(result.size(), 3);
+    ASSERT_EQ(result[0].ival, 2147483647);
+    ASSERT_EQ(result[1].ival, 2147483647);
+    ASSERT_EQ(result[2].ival, 0);
+
+    ASSERT_THROW(l.make_tokens("int a = 2147483648;"), NumberOverflowError);
+    ASSERT_THROW(l.make_tokens("99999999999999999999999"), NumberOverflowError);
+    ASSERT_THROW(l.make_tokens("a = ."), InvalidNumberError);
+
+    try
+    {
+        l.make_tokens("int a = 1;\n  a = 4294967296;");
+        FAIL();
+    }
+    catch (const NumberOverflowError& e)
+    {
+        ASSERT_EQ(e.what(), "Number '4294967296' is out of range at 2 line, 7 column");
+    }
+}
+
+TEST(LEXER_LITERALS, FLOAT_ROUNDING)
+{
+    Lexer l;
+
+    std::vector<std::string> literals =
+    {
+        "0.1", "3.14159265358979323846264338327950288", "16777216.5", "16777217.0", "16777219.0",
+        "16777217.000000000000000000000000000000000000000000000000000000000000000001",
+        "0.000000000000000000000000000000000000000000001401298464324817070923729583289916131280",
+        "0.0000000000000000000000000000000000000000000007006492321624085354618647916449580656401",
+        "0.0000000000000000000000000000000000000000000007006492321624085354618647916449580656402",
+        "0.000000000000000000000000000000000000011754942", "340282346638528859811704183484516925440.0",
+        "340282356779733661637539395458142568447.9999", ".5", "7.", "0000.00001",
+        "0." + std::string(400, '3'), "0." + std::string(900, '9'), "1." + std::string(800, '0') + "1",
+    };
+
+    for (int i = 0; i < 1000; i++)
+    {
+        literals.push_back(std::to_string(i * 7919 % 100003) + "." + std::to_string(i * 104729 % 1000003));
+    }
+
+    for (size_t i = 0; i < literals.size(); i++)
+    {
+        std::vector<Token> result = l.make_tokens(literals[i]);
+
+        ASSERT_EQ(result.size(), 1);
+        ASSERT_EQ(result[0].type, Token::FLOAT);
+        ASSERT_EQ(result[0].fval, strtof(literals[i].c_str(), 0)) << literals[i];
+    }
+
+    ASSERT_EQ(l.make_tokens("16777217.0")[0].fval, 16777216.f);
+    ASSERT_EQ(l.make_tokens("16777217.00000000000000000000001")[0].fval, 16777218.f);
+
+    ASSERT_THROW(l.make_tokens("340282356779733661637539395458142568448.0"), NumberOverflowError);
+    ASSERT_THROW(l.make_tokens(std::string(50, '9') + ".5"), NumberOverflowError);
+    ASSERT_EQ(l.make_tokens("0." + std::string(60, '0') + "1")[0].fval, 0.f);
+}
@@ -1,65 +1,69 @@
 #include <Parser.h>
+#include <FlatAst.h>
+#include <Document.h>
 #include <gtest/gtest.h>
 
 TEST(PARSER_NODES_IS_SAME_TEST, IS_SAME_TEST)
 {
+    AstArena ast;
+
     IntNumNode i1(12), i2(13);
     FloatNumNode f1(15.5f), f2(15.f);
 
-    SumNode sum1(std::shared_ptr<Node>(new IntNumNode(1)), std::shared_ptr<Node>(new IntNumNode(2))),
-    sum2(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(1))),
-    sum3(std::shared_ptr<Node>(new MultiplicationNode(
-        std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(2))
-    )), std::shared_ptr<Node>(new IntNumNode(2)));
+    SumNode sum1(ast.make<IntNumNode>(1), ast.make<IntNumNode>(2)),
+    sum2(ast.make<IntNumNode>(2), ast.make<IntNumNode>(1)),
+    sum3(ast.make<MultiplicationNode>(
+        ast.make<IntNumNode>(2), ast.make<IntNumNode>(2)
+    ), ast.make<IntNumNode>(2));
 
-    MultiplicationNode mul1(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(3))),
-    mul2(std::shared_ptr<Node>(new IntNumNode(3)), std::shared_ptr<Node>(new IntNumNode(2))),
-    mul3(std::shared_ptr<Node>(new SumNode(
-        std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(2))
-    )), std::shared_ptr<Node>(new IntNumNode(2)));
+    MultiplicationNode mul1(ast.make<IntNumNode>(2), ast.make<IntNumNode>(3)),
+    mul2(ast.make<IntNumNode>(3), ast.make<IntNumNode>(2)),
+    mul3(ast.make<SumNode>(
+        ast.make<IntNumNode>(2), ast.make<IntNumNode>(2)
+    ), ast.make<IntNumNode>(2));
 
     DeclareVariableNode v1(INTEGER_TYPE, "a"), 
     v2(INTEGER_TYPE, "b"), 
     v3(FLOAT_TYPE, "c"), 
-    v4(DeclareVariableNode(INTEGER_TYPE, "d", std::shared_ptr<Node>(&i1)));
+    v4(DeclareVariableNode(INTEGER_TYPE, "d", &i1));
 
     VariableNode var1("e", Type(INTEGER_TYPE)), var2("f", Type(FLOAT_TYPE)), var3("g", Type(FLOAT_TYPE));
 
     SequenceNode s1, s2;
 
-    s1.nodes = { std::shared_ptr<Node>(new DeclareVariableNode(v1)), std::shared_ptr<Node>(new DeclareVariableNode(v2)) };
-    s2.nodes = { std::shared_ptr<Node>(new DeclareVariableNode(v3)), std::shared_ptr<Node>(new DeclareVariableNode(v4)) };
+    s1.nodes = { ast.make<DeclareVariableNode>(v1), ast.make<DeclareVariableNode>(v2) };
+    s2.nodes = { ast.make<DeclareVariableNode>(v3), ast.make<DeclareVariableNode>(v4) };
 
-    std::shared_ptr<Node> statement1(new LesserNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(3)))),
-    statement2(new GreaterNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(3))));
+    Node* statement1 = ast.make<LesserNode>(ast.make<IntNumNode>(2), ast.make<IntNumNode>(3)),
+    *statement2 = ast.make<GreaterNode>(ast.make<IntNumNode>(2), ast.make<IntNumNode>(3));
 
-    std::shared_ptr<Node> if_body1(new IntNumNode(2)), if_body2(new FloatNumNode(2.f)), else_body1(new IntNumNode(3)), else_body2(new FloatNumNode(3.f));
+    Node* if_body1 = ast.make<IntNumNode>(2), *if_body2 = ast.make<FloatNumNode>(2.f), *else_body1 = ast.make<IntNumNode>(3), *else_body2 = ast.make<FloatNumNode>(3.f);
 
-    std::vector<std::shared_ptr<Node>> statements = { statement1, statement2 };
-    std::vector<std::shared_ptr<Node>> if_bodies = { if_body1, if_body2 };
-    std::vector<std::shared_ptr<Node>> else_bodies = { else_body1, else_body2 };
+    std::vector<Node*> statements = { statement1, statement2 };
+    std::vector<Node*> if_bodies = { if_body1, if_body2 };
+    std::vector<Node*> else_bodies = { else_body1, else_body2 };
 
-    std::vector<std::shared_ptr<Node>> branching_nodes;
+    std::vector<Node*> branching_nodes;
 
     for (auto i : statements)
     {
         for (auto j : if_bodies)
         {
-            branching_nodes.push_back(std::shared_ptr<Node>(new BranchingNode(i, j)));
+            branching_nodes.push_back(ast.make<BranchingNode>(i, j));
 
             for (auto k : else_bodies)
             {
-                branching_nodes.push_back(std::shared_ptr<Node>(new BranchingNode(i, j, k)));
+                branching_nodes.push_back(ast.make<BranchingNode>(i, j, k));
             }
         }
     }
 
     for (int i = 0; i < branching_nodes.size(); i++)
     {
-        ASSERT_TRUE(branching_nodes[i]->is_same(branching_nodes[i].get()));
+        ASSERT_TRUE(branching_nodes[i]->is_same(branching_nodes[i]));
         for (int j = i + 1; j < branching_nodes.size(); j++)
         {
-            ASSERT_FALSE(branching_nodes[i]->is_same(branching_nodes[j].get()));
+            ASSERT_FALSE(branching_nodes[i]->is_same(branching_nodes[j]));
         }
     }
 
@@ -98,247 +102,265 @@ TEST(PARSER_NODES_IS_SAME_TEST, IS_SAME_TEST)
 
 TEST(PARSER_VARIABLE_TEST, BASIC_VARIABLE)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::INTTYPE), Token("a"), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
+    SequenceNode* expected = ast.make<SequenceNode>();
     expected->nodes.push_back(
-        std::shared_ptr<Node>(
-            new DeclareVariableNode(INTEGER_TYPE, "a")));
+        ast.make<DeclareVariableNode>(INTEGER_TYPE, "a"));
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, INT_VARIABLE_ASSIGN)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::INTTYPE), Token("a"), EQUAL_T, IntegerToken(2), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(new IntNumNode(2)))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<IntNumNode>(2)) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, FLOAT_VARIABLE_ASSIGN)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::FLOATTYPE), Token("a"), EQUAL_T, Token(2.f), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(FLOAT_TYPE, "a", std::shared_ptr<Node>(new FloatNumNode(2.f)))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(FLOAT_TYPE, "a", ast.make<FloatNumNode>(2.f)) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, INT_VARIABLE_ASSIGN_SUM)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::INTTYPE), Token("a"), EQUAL_T, IntegerToken(2), PLUS_T, IntegerToken(2), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(
-        new SumNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(2)))))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<SumNode>(ast.make<IntNumNode>(2), ast.make<IntNumNode>(2))) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, FLOAT_VARIABLE_ASSIGN_SUM)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::FLOATTYPE), Token("a"), EQUAL_T, Token(2.f), PLUS_T, Token(3.f), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(FLOAT_TYPE, "a", std::shared_ptr<Node>(
-        new SumNode(std::shared_ptr<Node>(new FloatNumNode(2.f)), std::shared_ptr<Node>(new FloatNumNode(3.f)))
-    ))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(FLOAT_TYPE, "a", ast.make<SumNode>(ast.make<FloatNumNode>(2.f), ast.make<FloatNumNode>(3.f))) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, INT_VARIABLE_ASSIGN_DIFF)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::INTTYPE), Token("a"), EQUAL_T, IntegerToken(2), MINUS_T, IntegerToken(2), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(
-        new SubtractNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(2)))))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<SubtractNode>(ast.make<IntNumNode>(2), ast.make<IntNumNode>(2))) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, FLOAT_VARIABLE_ASSIGN_DIFF)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::FLOATTYPE), Token("a"), EQUAL_T, Token(2.f), MINUS_T, Token(3.f), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(FLOAT_TYPE, "a", std::shared_ptr<Node>(
-        new SubtractNode(std::shared_ptr<Node>(new FloatNumNode(2.f)), std::shared_ptr<Node>(new FloatNumNode(3.f)))
-    ))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(FLOAT_TYPE, "a", ast.make<SubtractNode>(ast.make<FloatNumNode>(2.f), ast.make<FloatNumNode>(3.f))) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, INT_VARIABLE_ASSIGN_MUL)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::INTTYPE), Token("a"), EQUAL_T, IntegerToken(2), ASTERISK_T, IntegerToken(2), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(
-        new MultiplicationNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(2)))))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<MultiplicationNode>(ast.make<IntNumNode>(2), ast.make<IntNumNode>(2))) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, FLOAT_VARIABLE_ASSIGN_MUL)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::FLOATTYPE), Token("a"), EQUAL_T, Token(2.f), ASTERISK_T, Token(3.f), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(FLOAT_TYPE, "a", std::shared_ptr<Node>(
-        new MultiplicationNode(std::shared_ptr<Node>(new FloatNumNode(2.f)), std::shared_ptr<Node>(new FloatNumNode(3.f)))
-    ))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(FLOAT_TYPE, "a", ast.make<MultiplicationNode>(ast.make<FloatNumNode>(2.f), ast.make<FloatNumNode>(3.f))) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, INT_VARIABLE_ASSIGN_DIV)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::INTTYPE), Token("a"), EQUAL_T, IntegerToken(2), SLASH_T, IntegerToken(2), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(
-        new DivisionNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(2)))))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<DivisionNode>(ast.make<IntNumNode>(2), ast.make<IntNumNode>(2))) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, FLOAT_VARIABLE_ASSIGN_DIV)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::FLOATTYPE), Token("a"), EQUAL_T, Token(2.f), SLASH_T, Token(3.f), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(FLOAT_TYPE, "a", std::shared_ptr<Node>(
-        new DivisionNode(std::shared_ptr<Node>(new FloatNumNode(2.f)), std::shared_ptr<Node>(new FloatNumNode(3.f)))
-    ))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(FLOAT_TYPE, "a", ast.make<DivisionNode>(ast.make<FloatNumNode>(2.f), ast.make<FloatNumNode>(3.f))) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, INT_VARIABLE_EXPRESSION_ORDER_ASSIGN1)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::INTTYPE), Token("a"), EQUAL_T, IntegerToken(2), PLUS_T, IntegerToken(2), ASTERISK_T, IntegerToken(2), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(
-        new SumNode(
-            std::shared_ptr<Node>(new MultiplicationNode(std::shared_ptr<Node>(new IntNumNode(2)), 
-            std::shared_ptr<Node>(new IntNumNode(2)))), std::shared_ptr<Node>(new IntNumNode(2)))))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<SumNode>(
+            ast.make<MultiplicationNode>(ast.make<IntNumNode>(2), 
+            ast.make<IntNumNode>(2)), ast.make<IntNumNode>(2))) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, INT_VARIABLE_EXPRESSION_ORDER_ASSIGN2)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::INTTYPE), Token("a"), EQUAL_T, LPARENTHESIS_T, IntegerToken(2), PLUS_T, IntegerToken(2), RPARENTHESIS_T, ASTERISK_T, IntegerToken(2), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(
-        new MultiplicationNode(
-            std::shared_ptr<Node>(new SumNode(std::shared_ptr<Node>(new IntNumNode(2)), 
-            std::shared_ptr<Node>(new IntNumNode(2)))), std::shared_ptr<Node>(new IntNumNode(2)))))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<MultiplicationNode>(
+            ast.make<SumNode>(ast.make<IntNumNode>(2), 
+            ast.make<IntNumNode>(2)), ast.make<IntNumNode>(2))) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, INT_VARIABLE_EXPRESSION_ORDER_ASSIGN3)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::INTTYPE), Token("a"), EQUAL_T, IntegerToken(2), ASTERISK_T, IntegerToken(2), PLUS_T, IntegerToken(2), SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(
-        new SumNode(
-            std::shared_ptr<Node>(new MultiplicationNode(std::shared_ptr<Node>(new IntNumNode(2)), 
-            std::shared_ptr<Node>(new IntNumNode(2)))), std::shared_ptr<Node>(new IntNumNode(2)))))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<SumNode>(
+            ast.make<MultiplicationNode>(ast.make<IntNumNode>(2), 
+            ast.make<IntNumNode>(2)), ast.make<IntNumNode>(2))) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, FLOAT_VARIABLE_EXPRESSION_ORDER_ASSIGN1)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::FLOATTYPE), Token("a"), EQUAL_T, Token(2.f), SLASH_T, LPARENTHESIS_T, Token(3.f), PLUS_T, Token(5.f), RPARENTHESIS_T, SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(FLOAT_TYPE, "a", std::shared_ptr<Node>(
-        new DivisionNode(std::shared_ptr<Node>(new FloatNumNode(2.f)), 
-        std::shared_ptr<Node>(new SumNode(std::shared_ptr<Node>(new FloatNumNode(3.f)), std::shared_ptr<Node>(new FloatNumNode(5.f)))))
-    ))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(FLOAT_TYPE, "a", ast.make<DivisionNode>(ast.make<FloatNumNode>(2.f), 
+        ast.make<SumNode>(ast.make<FloatNumNode>(3.f), ast.make<FloatNumNode>(5.f)))) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, FLOAT_EXPRESSION_ASSIGN_COMPLEX_EXPRESSION)
 {
+    AstArena ast;
+
     // float a = (3.f * 7.f + 2.f) / (15.f - 1.f); -> Div(Sum(Mul(3, 7), 2), Diff(15, 1))
     Parser p({ Token(Token::FLOATTYPE), Token("a"), EQUAL_T, LPARENTHESIS_T, Token(3.f), ASTERISK_T, Token(7.f), PLUS_T, Token(2.f), RPARENTHESIS_T, 
     SLASH_T, LPARENTHESIS_T, Token(15.f), MINUS_T, Token(1.f), RPARENTHESIS_T, SEMICOLON_T});
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(FLOAT_TYPE, "a", std::shared_ptr<Node>(
-        std::shared_ptr<Node>(new DivisionNode(std::shared_ptr<Node>(new SumNode(std::shared_ptr<Node>(new MultiplicationNode(
-            std::shared_ptr<Node>(new FloatNumNode(3.f)), std::shared_ptr<Node>(new FloatNumNode(7.f))
-        )),
-        std::shared_ptr<Node>(new FloatNumNode(2.f)))),
-        std::shared_ptr<Node>(new SubtractNode(
-            std::shared_ptr<Node>(new FloatNumNode(15.f)),
-            std::shared_ptr<Node>(new FloatNumNode(1.f))
-        ))
-    ))))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(FLOAT_TYPE, "a", 
+        ast.make<DivisionNode>(ast.make<SumNode>(ast.make<MultiplicationNode>(
+            ast.make<FloatNumNode>(3.f), ast.make<FloatNumNode>(7.f)
+        ),
+        ast.make<FloatNumNode>(2.f)),
+        ast.make<SubtractNode>(
+            ast.make<FloatNumNode>(15.f),
+            ast.make<FloatNumNode>(1.f)
+        )
+    )) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_VARIABLE_TEST, REUSE_VARIABLE)
 {
+    AstArena ast;
+
     // float a = (3.f * 7.f + 2.f) / (15.f - 1.f); -> Div(Sum(Mul(3, 7), 2), Diff(15, 1))
     Parser p({ Token(Token::FLOATTYPE), Token("a"), EQUAL_T, Token(2.f), PLUS_T, Token(2.f), SEMICOLON_T, 
     Token(Token::FLOATTYPE), Token("b"), EQUAL_T, Token("a"), PLUS_T, Token(2.f), SEMICOLON_T});
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(FLOAT_TYPE, "a", std::shared_ptr<Node>(new SumNode(
-        std::shared_ptr<Node>(new FloatNumNode(2.f)),
-        std::shared_ptr<Node>(new FloatNumNode(2.f))
-    )))),
-    std::shared_ptr<Node>(new DeclareVariableNode(FLOAT_TYPE, "b", std::shared_ptr<Node>(std::shared_ptr<Node>(new SumNode(
-        std::shared_ptr<Node>(new VariableNode("a", Type(FLOAT_TYPE))),
-        std::shared_ptr<Node>(new FloatNumNode(2.f))
-    ))))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(FLOAT_TYPE, "a", ast.make<SumNode>(
+        ast.make<FloatNumNode>(2.f),
+        ast.make<FloatNumNode>(2.f)
+    )),
+    ast.make<DeclareVariableNode>(FLOAT_TYPE, "b", ast.make<SumNode>(
+        ast.make<VariableNode>("a", Type(FLOAT_TYPE)),
+        ast.make<FloatNumNode>(2.f)
+    )) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_PRINT_TEST, BASIC_PRINT)
 {
+    AstArena ast;
+
     Parser p({ PRINT_T, LPARENTHESIS_T, IntegerToken(2), PLUS_T, IntegerToken(2), RPARENTHESIS_T, SEMICOLON_T });
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
 
-    std::shared_ptr<PrintNode> print(new PrintNode());
-    print->expressions.push_back(std::shared_ptr<Node>(new SumNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(2)))));
+    PrintNode* print = ast.make<PrintNode>();
+    print->expressions.push_back(ast.make<SumNode>(ast.make<IntNumNode>(2), ast.make<IntNumNode>(2)));
 
-    std::shared_ptr<SequenceNode> expected(new SequenceNode()); 
+    SequenceNode* expected = ast.make<SequenceNode>(); 
     expected->nodes = { print };
 
     ASSERT_TRUE(expected->is_same(result.get()));
@@ -346,64 +368,68 @@ TEST(PARSER_PRINT_TEST, BASIC_PRINT)
 
 TEST(PARSER_ASSIGN_TEST, ASSIGN)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::INTTYPE), Token("a"), EQUAL_T, IntegerToken(2), PLUS_T, IntegerToken(2), SEMICOLON_T,
     Token("a"), EQUAL_T, IntegerToken(2), ASTERISK_T, Token("a"), PLUS_T, IntegerToken(2), SEMICOLON_T }); // int a = 2 + 2; a = 2 * a + 2;
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
 
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(
-        new SumNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(2)))
-    ))),
-    std::shared_ptr<Node>(new AssignNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<Node>(new SumNode(
-        std::shared_ptr<Node>(new MultiplicationNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)))),
-        std::shared_ptr<Node>(new IntNumNode(2))
-    )))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<SumNode>(ast.make<IntNumNode>(2), ast.make<IntNumNode>(2))),
+    ast.make<AssignNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<SumNode>(
+        ast.make<MultiplicationNode>(ast.make<IntNumNode>(2), ast.make<VariableNode>("a", INTEGER_TYPE)),
+        ast.make<IntNumNode>(2)
+    )) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_BRANCHING, BASIC_BRANCHING)
 {
+    AstArena ast;
+
     Parser p({ IF_T, LPARENTHESIS_T, IntegerToken(2), PLUS_T, IntegerToken(2), LESSER_T, IntegerToken(3), RPARENTHESIS_T,
     LBRACE_T, PRINT_T, LPARENTHESIS_T, IntegerToken(1), RPARENTHESIS_T, SEMICOLON_T, RBRACE_T, ELSE_T,
     LBRACE_T, PRINT_T, LPARENTHESIS_T, IntegerToken(0), RPARENTHESIS_T, SEMICOLON_T, RBRACE_T, SEMICOLON_T }); // if (2 + 2 < 3) { print(1); } else { print(0); };
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
 
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<BranchingNode>(new BranchingNode(std::shared_ptr<Node>(new LesserNode(
-        std::shared_ptr<Node>(new SumNode(std::shared_ptr<Node>(new IntNumNode(2)), std::shared_ptr<Node>(new IntNumNode(2)))),
-        std::shared_ptr<Node>(new IntNumNode(3))
-    )),
-    std::shared_ptr<Node>(new SequenceNode({ std::shared_ptr<Node>(new PrintNode({ std::shared_ptr<Node>(new IntNumNode(1)) })) })),
-    std::shared_ptr<Node>(new SequenceNode({ std::shared_ptr<Node>(new PrintNode({ std::shared_ptr<Node>(new IntNumNode(0)) })) }))
-    )) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<BranchingNode>(ast.make<LesserNode>(
+        ast.make<SumNode>(ast.make<IntNumNode>(2), ast.make<IntNumNode>(2)),
+        ast.make<IntNumNode>(3)
+    ),
+    ast.make<SequenceNode>(std::vector<Node*>{ ast.make<PrintNode>(std::vector<Node*>{ ast.make<IntNumNode>(1) }) }),
+    ast.make<SequenceNode>(std::vector<Node*>{ ast.make<PrintNode>(std::vector<Node*>{ ast.make<IntNumNode>(0) }) })
+    ) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_CYCLING, BASIC_FOR_CYCLING)
 {
+    AstArena ast;
+
     Parser p({ FOR_T, LPARENTHESIS_T, Token(Token::INTTYPE), Token("a"), EQUAL_T, IntegerToken(0), SEMICOLON_T, 
     Token("a"), LESSER_T, IntegerToken(5), SEMICOLON_T, Token("a"), EQUAL_T, Token("a"), PLUS_T, IntegerToken(1), RPARENTHESIS_T,
     LBRACE_T, PRINT_T, LPARENTHESIS_T, Token("a"), RPARENTHESIS_T, SEMICOLON_T, RBRACE_T, SEMICOLON_T }); // for (int a = 0; a < 5; a = a + 1) { print(a); };
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
 
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<ForCycleNode>(new ForCycleNode(std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(new IntNumNode(0)))),
-    std::shared_ptr<Node>(new LesserNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<Node>(new IntNumNode(5)))),
-    std::shared_ptr<Node>(new AssignNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<SumNode>(
-        new SumNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<Node>(new IntNumNode(1)))
-    ))),
-    std::shared_ptr<Node>(new SequenceNode({ std::shared_ptr<Node>(new PrintNode({ std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)) })) })))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<ForCycleNode>(ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<IntNumNode>(0)),
+    ast.make<LesserNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<IntNumNode>(5)),
+    ast.make<AssignNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<SumNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<IntNumNode>(1))),
+    ast.make<SequenceNode>(std::vector<Node*>{ ast.make<PrintNode>(std::vector<Node*>{ ast.make<VariableNode>("a", INTEGER_TYPE) }) })) };
 
     ASSERT_TRUE(expected->is_same(result.get()));
 }
 
 TEST(PARSER_CYCLING, BASIC_WHILE_CYCLING)
 {
+    AstArena ast;
+
     Parser p({ Token(Token::INTTYPE), Token("a"), EQUAL_T, IntegerToken(0), SEMICOLON_T, 
     WHILE_T, LPARENTHESIS_T, Token("a"), LESSER_T, IntegerToken(5), RPARENTHESIS_T,
     LBRACE_T, Token("a"), EQUAL_T, Token("a"), PLUS_T, IntegerToken(1), SEMICOLON_T, 
@@ -411,16 +437,257 @@ TEST(PARSER_CYCLING, BASIC_WHILE_CYCLING)
 
     std::shared_ptr<SequenceNode> result = p.make_tree();
 
-    std::shared_ptr<SequenceNode> expected(new SequenceNode());
-    expected->nodes = { std::shared_ptr<Node>(new DeclareVariableNode(INTEGER_TYPE, "a", std::shared_ptr<Node>(new IntNumNode(0)))),
-    std::shared_ptr<WhileCycleNode>(new WhileCycleNode(
-    std::shared_ptr<Node>(new LesserNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<Node>(new IntNumNode(5)))),
-    std::shared_ptr<Node>(new SequenceNode({ 
-        std::shared_ptr<Node>(new AssignNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<SumNode>(
-        new SumNode(std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)), std::shared_ptr<Node>(new IntNumNode(1)))
-    ))),
-    std::shared_ptr<Node>(new PrintNode({ std::shared_ptr<Node>(new VariableNode("a", INTEGER_TYPE)) })) 
-    })))) };
+    SequenceNode* expected = ast.make<SequenceNode>();
+    expected->nodes = { ast.make<DeclareVariableNode>(INTEGER_TYPE, "a", ast.make<IntNumNode>(0)),
+    ast.make<WhileCycleNode>(
+    ast.make<LesserNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<IntNumNode>(5)),
+    ast.make<SequenceNode>(std::vector<Node*>{ 
+        ast.make<AssignNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<SumNode>(ast.make<VariableNode>("a", INTEGER_TYPE), ast.make<IntNumNode>(1))),
+    ast.make<PrintNode>(std::vector<Node*>{ ast.make<VariableNode>("a", INTEGER_TYPE) }) 
+    })) };
+
+    ASSERT_TRUE(expected->is_same(result.get()));
+}
+
+TEST(PARSER_ERRORS, ERROR_POSITION)
+{
+    Lexer l;
+
+    std::string code = "int a = 2;\nint b = a +\n  c;";
+
+    Parser p(l.make_tokens(code), &l.line_index());
+
+    try
+    {
+        p.make_tree();
+        FAIL();
+    }
+    catch (const UndefinedNameError& e)
+    {
+        ASSERT_EQ(e.what(), std::string("Undefined name \'c\' at 3 line, 3 column"));
+    }
+}
+
+TEST(PARSER_STREAM, PULL_FROM_LEXER)
+{
+    std::string code = "int a = 0; while (a < 5) { a = a + 1; print(a); };";
+
+    Lexer l;
+
+    Parser expected_parser(l.make_tokens(code));
+    std::shared_ptr<SequenceNode> expected = expected_parser.make_tree();
+
+    l.begin(code);
+
+    Parser p(l, &l.line_index());
+    std::shared_ptr<SequenceNode> result = p.make_tree();
+
+    ASSERT_EQ(result->nodes.size(), 2);
+    ASSERT_TRUE(expected->is_same(result.get()));
+}
+
+TEST(PARSER_TOKEN_BUFFER, PARSE_TOKEN_BUFFER)
+{
+    std::string code = "int a = 0; for (int i = 0; i < 10; i = i + 1) { a = a + i * 2; };";
+
+    Lexer l;
+
+    Parser expected_parser(l.make_tokens(code));
+    std::shared_ptr<SequenceNode> expected = expected_parser.make_tree();
+
+    TokenBuffer buffer;
+    l.make_tokens(code.data(), code.size(), buffer);
+
+    Parser p(buffer);
+    std::shared_ptr<SequenceNode> result = p.make_tree();
 
+    ASSERT_EQ(result->nodes.size(), 2);
     ASSERT_TRUE(expected->is_same(result.get()));
-}
\ No newline at end of file
+}
+
+static std::shared_ptr<SequenceNode> parse_text(const std::string& code)
+{
+    Lexer l;
+    Parser p(l.make_tokens(code));
+
+    return p.make_tree();
+}
+
+static void apply_edit(Document& d, const std::string& from, const std::string& to)
+{
+    size_t offset = d.text().find(from);
+
+    ASSERT_NE(offset, std::string::npos);
+
+    d.edit(offset, from.size(), to);
+
+    ASSERT_TRUE(d.tree());
+    ASSERT_TRUE(d.tree()->is_same(parse_text(d.text()).get())) << d.text();
+}
+
+TEST(PARSER_INCREMENTAL, REUSE_SUBTREES)
+{
+    std::string code = "int a = 0;\nfloat b = 1.5;\nwhile (a < 10) {\n    a = a + 1;\n    print(a, b);\n};\nprint(a);";
+
+    Document d;
+    d.reset(code);
+
+    std::shared_ptr<SequenceNode> tree = d.tree();
+    Node* loop = tree->nodes[2];
+    SequenceNode* body = static_cast<SequenceNode*>(static_cast<WhileCycleNode*>(loop)->body);
+    Node* body_print = body->nodes[1];
+
+    apply_edit(d, "a + 1", "a + 2 * a");
+
+    ASSERT_EQ(d.reparsed_length(), std::string("a = a + 2 * a;").size());
+    ASSERT_EQ(d.tree(), tree);
+    ASSERT_EQ(tree->nodes[2], loop);
+    ASSERT_EQ(body->nodes[1], body_print);
+
+    apply_edit(d, "print(a);", "b = b * 2.;\nprint(a);");
+
+    ASSERT_EQ(tree->nodes.size(), 5);
+    ASSERT_EQ(tree->nodes[2], loop);
+
+    Node* body_assign = body->nodes[0];
+
+    apply_edit(d, "print(a, b);", "print(a, b);\n    b = 3.;");
+
+    ASSERT_EQ(body->nodes.size(), 3);
+    ASSERT_EQ(body->nodes[0], body_assign);
+    ASSERT_EQ(tree->nodes[2], loop);
+
+    // Touches the braces, so the whole loop is parsed again
+    apply_edit(d, "\n};", "\n}  ;");
+    apply_edit(d, "}  ;", "};");
+
+    apply_edit(d, "    a = a", "\n    \n    a = a");
+    apply_edit(d, ";\nprint(a);", "; print(a); print(b);");
+    apply_edit(d, "(a < 10)", "(a < 20)");
+    apply_edit(d, " print(b);", "");
+
+    ASSERT_EQ(d.text(), "int a = 0;\nfloat b = 1.5;\nwhile (a < 20) {\n\n    \n    a = a + 2 * a;\n    print(a, b);\n    b = 3.;\n};\nb = b * 2.; print(a);");
+}
+
+TEST(PARSER_INCREMENTAL, DECLARATIONS_AND_ERRORS)
+{
+    Document d;
+    d.reset("int a = 1;\nfloat b = 2.;\nif (a > 0) { b = b + a; } else { b = 0.; };\nprint(b);");
+
+    apply_edit(d, "int a = 1;", "int a = 7;");
+
+    // Retyping a declaration changes the nodes that use it
+    apply_edit(d, "float b", "int b");
+    apply_edit(d, "int b", "float b");
+
+    ASSERT_THROW(d.edit(d.text().find("b + a"), 1, "c"), UndefinedNameError);
+    ASSERT_FALSE(d.tree());
+
+    apply_edit(d, "c + a", "b + a");
+
+    ASSERT_THROW(d.edit(d.text().find("b = 0."), 0, "}"), ParserException);
+
+    apply_edit(d, "}b = 0.", "b = 0.");
+
+    // Later declarations aren't visible yet
+    ASSERT_THROW(d.edit(0, 0, "a = 2;"), UndefinedNameError);
+
+    apply_edit(d, "a = 2;", "");
+
+    ASSERT_EQ(d.text(), "int a = 7;\nfloat b = 2.;\nif (a > 0) { b = b + a; } else { b = 0.; };\nprint(b);");
+}
+
+TEST(PARSER_FLAT_AST, ROUND_TRIP)
+{
+    std::string code = "int a = 0;\nfloat b = 1.5;\nfor (int i = 0; i < 3 || a >= 2 && b <= 1.; i = i + 1) { a = a - i / 2; };\n"
+        "while (a == 0) { if (b > 1.) { print(a, b * 2.); } else { b = 0.; }; };\nif (a < 1) { print(1); } else { print(2.5); };";
+
+    std::shared_ptr<SequenceNode> tree = parse_text(code);
+
+    FlatAst flat(tree.get());
+
+    ASSERT_EQ(sizeof(FlatNode), 16);
+    ASSERT_EQ(flat.at(flat.root()).tag, Node::SEQUENCE);
+    ASSERT_EQ(flat.at(flat.root()).b, tree->nodes.size());
+
+    AstArena ast;
+
+    ASSERT_TRUE(tree->is_same(flat.to_tree(ast)));
+}
+
+TEST(PARSER_EXPRESSION, PRECEDENCE)
+{
+    AstArena ast;
+
+    // Comparisons bind loosest, then && and ||, then arithmetic
+    std::shared_ptr<SequenceNode> result = parse_text("int a = 1;\nif ((a + 1) * 2 < 3 || a - 4 / a) { print(a); } else { print(a); };");
+
+    VariableNode* a = ast.make<VariableNode>("a", INTEGER_TYPE);
+    SequenceNode* body = ast.make<SequenceNode>(std::vector<Node*>{ ast.make<PrintNode>(std::vector<Node*>{ a }) });
+
+    Node* expected = ast.make<BranchingNode>(ast.make<LesserNode>(
+        ast.make<MultiplicationNode>(ast.make<SumNode>(a, ast.make<IntNumNode>(1)), ast.make<IntNumNode>(2)),
+        ast.make<ORNode>(ast.make<IntNumNode>(3), ast.make<SubtractNode>(a, ast.make<DivisionNode>(ast.make<IntNumNode>(4), a)))
+    ), body, body);
+
+    ASSERT_TRUE(expected->is_same(result->nodes[1]));
+
+    // Arithmetic contexts stop at the first comparison, even in parentheses
+    ASSERT_THROW(parse_text("int a = 1;\nint b = (a < 2);\nprint(b);"), UnexpectedTokenError);
+}
+
+TEST(PARSER_ERRORS, ALL_DIAGNOSTICS)
+{
+    Lexer l;
+
+    std::string code = "int a = 2;\nb = a;\nwhile (a < ) { a = c; };\nif (a < 1) { a = c; } else { print(); };\nint d = a + ;\nprint(d);\nprint(a";
+
+    Parser p(l.make_tokens(code), &l.line_index());
+    p.make_sequence();
+
+    const std::vector<std::shared_ptr<ParserException>>& diagnostics = p.get_diagnostics();
+
+    ASSERT_EQ(diagnostics.size(), 6);
+    ASSERT_EQ(diagnostics[0]->what(), std::string("Undefined name \'b\' at 2 line, 1 column"));
+    // The rest of a broken statement is skipped, blocks included
+    ASSERT_EQ(diagnostics[1]->what(), std::string("Unexpected token ) at 3 line, 12 column"));
+    ASSERT_EQ(diagnostics[2]->what(), std::string("Undefined name \'c\' at 4 line, 18 column"));
+    ASSERT_EQ(diagnostics[3]->what(), std::string("Expected expression inside \'print\' function"));
+    ASSERT_EQ(diagnostics[4]->what(), std::string("Unexpected token ; at 5 line, 13 column"));
+    ASSERT_EQ(diagnostics[5]->what(), std::string("End of file!"));
+
+    // d is still declared, so print(d) is fine. make_tree() throws the first one.
+    ASSERT_THROW(Parser(l.make_tokens(code)).make_tree(), UndefinedNameError);
+}
+
+TEST(PARSER_RESOLVER, SLOTS)
+{
+    std::shared_ptr<SequenceNode> tree = parse_text("int a = 1;\nfloat b = 2.;\nwhile (a < 3) { int c = a; a = c + 1; };\nb = b * a;");
+
+    DeclareVariableNode* a = static_cast<DeclareVariableNode*>(tree->nodes[0]);
+    DeclareVariableNode* b = static_cast<DeclareVariableNode*>(tree->nodes[1]);
+
+    SequenceNode* body = static_cast<SequenceNode*>(static_cast<WhileCycleNode*>(tree->nodes[2])->body);
+    DeclareVariableNode* c = static_cast<DeclareVariableNode*>(body->nodes[0]);
+
+    BinaryNode* assign = static_cast<BinaryNode*>(tree->nodes[3]);
+    BinaryNode* product = static_cast<BinaryNode*>(assign->right);
+
+    ASSERT_EQ(a->slot, 0);
+    ASSERT_EQ(b->slot, 1);
+    ASSERT_EQ(c->slot, 2);
+    ASSERT_EQ(static_cast<VariableNode*>(c->expression)->slot, 0);
+    ASSERT_EQ(static_cast<VariableNode*>(assign->left)->slot, 1);
+    ASSERT_EQ(static_cast<VariableNode*>(product->right)->slot, 0);
+
+    // Reparsed statements keep using the document's slots
+    Document d;
+    d.reset("int a = 1;\nfloat b = 2.;\nb = b * a;");
+    d.edit(d.text().find("b * a"), 5, "a + b");
+
+    BinaryNode* sum = static_cast<BinaryNode*>(static_cast<BinaryNode*>(d.tree()->nodes[2])->right);
+
+    ASSERT_EQ(d.reparsed_length(), std::string("b = a + b;").size());
+    ASSERT_EQ(static_cast<VariableNode*>(sum->left)->slot, 0);
+    ASSERT_EQ(static_cast<VariableNode*>(sum->right)->slot, 1);
+}
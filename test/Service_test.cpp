@@ -43,4 +43,23 @@ TEST(PRACTICAL_USE, FIBONACCI_NUMBERS)
     i.run(sn.get());
 
     ASSERT_EQ(testing::internal::GetCapturedStdout(), fibb_nums(20));
-}
\ No newline at end of file
+}
+
+TEST(PRACTICAL_USE, FIBONACCI_NUMBERS_BYTECODE)
+{
+    Lexer l;
+
+    std::string input = "int a = 0;int b = 1;int c;int n = 20;for (int i = 0; i < n; i = i + 1){c = a + b;a = b;b = c;print(b);};";
+
+    Parser p(l.make_tokens(input));
+
+    std::shared_ptr<SequenceNode> sn = p.make_tree();
+
+    Interpreter i(Interpreter::BYTECODE);
+
+    testing::internal::CaptureStdout();
+
+    i.run(sn.get());
+
+    ASSERT_EQ(testing::internal::GetCapturedStdout(), fibb_nums(20));
+}